@@ -0,0 +1,98 @@
+#include "kami/math/edge_block.hpp"
+#include "kami/math/predicates.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Microbenchmark of the crossing tests: one edge against a block of edges with
+// EdgeBlock::getCrossings, and the same pairs with math::segmentsCross.
+//
+// Usage : edge_block_bench [edges] [queries]
+
+using namespace kami::math;
+
+static const char *getKernel() {
+#if defined(__AVX__)
+  return "AVX";
+#elif defined(__SSE2__)
+  return "SSE2";
+#else
+  return "scalar";
+#endif
+}
+
+/**
+ * @brief Random edges of a unit square, short enough for some of them to
+ * cross, some of them sharing a vertex with the previous one as along the
+ * boundary of a facet
+ */
+static std::vector<Edge> makeEdges(size_t n, std::mt19937 &gen) {
+  std::uniform_real_distribution<double> pos(0, 1), step(-0.05, 0.05);
+  std::vector<Edge> edges;
+  Vertex last(pos(gen), pos(gen), 0);
+  for (size_t i = 0; i < n; i++) {
+    Vertex first = (i % 3 == 0) ? Vertex(pos(gen), pos(gen), 0) : last;
+    last = Vertex(first(0) + step(gen), first(1) + step(gen), 0);
+    edges.push_back(Edge(first, last));
+  }
+  return edges;
+}
+
+int main(int argc, char **argv) {
+  size_t n_edges = (argc > 1) ? std::atol(argv[1]) : 4096;
+  size_t n_queries = (argc > 2) ? std::atol(argv[2]) : 4096;
+
+  std::mt19937 gen(42);
+  std::vector<Edge> edges = makeEdges(n_edges, gen);
+  std::vector<Edge> queries = makeEdges(n_queries, gen);
+  EdgeBlock block;
+  for (const Edge &edge : edges)
+    block.push_back(edge);
+
+  // Scalar reference, one mask per query and chunk of the block
+  size_t n_chunks = (n_edges + EdgeBlock::MASK_SIZE - 1) / EdgeBlock::MASK_SIZE;
+  std::vector<uint64_t> expected(n_queries * n_chunks, 0);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (size_t q = 0; q < n_queries; q++) {
+    for (size_t j = 0; j < n_edges; j++) {
+      if (segmentsCross(queries[q], edges[j]))
+        expected[q * n_chunks + j / EdgeBlock::MASK_SIZE] |=
+            (uint64_t)1 << (j % EdgeBlock::MASK_SIZE);
+    }
+  }
+  auto end = std::chrono::high_resolution_clock::now();
+  double scalar_s = std::chrono::duration<double>(end - start).count();
+
+  // Block kernel
+  std::vector<uint64_t> masks(n_queries * n_chunks, 0);
+  start = std::chrono::high_resolution_clock::now();
+  for (size_t q = 0; q < n_queries; q++) {
+    for (size_t c = 0; c < n_chunks; c++) {
+      size_t first = c * EdgeBlock::MASK_SIZE;
+      size_t n = std::min(EdgeBlock::MASK_SIZE, n_edges - first);
+      masks[q * n_chunks + c] = block.getCrossings(queries[q], first, n);
+    }
+  }
+  end = std::chrono::high_resolution_clock::now();
+  double block_s = std::chrono::duration<double>(end - start).count();
+
+  size_t hits = 0, mismatches = 0;
+  for (size_t k = 0; k < masks.size(); k++) {
+    hits += __builtin_popcountll(expected[k]);
+    mismatches += (masks[k] != expected[k]);
+  }
+
+  double pairs = (double)n_edges * n_queries;
+  std::cout << "Kernel : " << getKernel() << std::endl;
+  std::cout << "Pairs : " << pairs << " (" << hits << " crossings)"
+            << std::endl;
+  std::cout << "segmentsCross : " << pairs / scalar_s / 1E6 << " Mpairs/s"
+            << std::endl;
+  std::cout << "getCrossings : " << pairs / block_s / 1E6 << " Mpairs/s"
+            << std::endl;
+  std::cout << "Speedup : " << scalar_s / block_s << std::endl;
+  std::cout << "Mismatching masks : " << mismatches << std::endl;
+  return (mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
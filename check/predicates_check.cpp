@@ -0,0 +1,188 @@
+#include "kami/math/edge_block.hpp"
+#include "kami/math/predicates.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Checks of the robust predicates and of the edge block polygon tests.
+// Returns a failure when one of them does not hold.
+
+using namespace kami::math;
+
+static int failures = 0;
+
+#define CHECK(cond)                                                            \
+  if (!(cond)) {                                                               \
+    std::cout << "FAILED line " << __LINE__ << ": " << #cond << std::endl;     \
+    failures++;                                                                \
+  }
+
+static EdgeBlock makePolygon(const std::vector<Vertex> &corners) {
+  EdgeBlock block;
+  for (size_t i = 0; i < corners.size(); i++)
+    block.push_back(Edge(corners[i], corners[(i + 1) % corners.size()]));
+  return block;
+}
+
+static Vertex at(double x, double y) { return Vertex(x, y, 0); }
+
+// ==========================================================================
+// Orientation
+// ==========================================================================
+
+static void checkOrientation() {
+  for (double s : {0.0, 1E6, 1E12}) {
+    // Aligned points, and a point one ulp above the line
+    double ax = s + 0.5, bx = s + 12, cx = s + 24;
+    CHECK(orient2d(ax, ax, bx, bx, cx, cx) == 0);
+    CHECK(orient2dExact(ax, ax, bx, bx, cx, cx) == 0);
+    double above = std::nextafter(cx, INFINITY);
+    double below = std::nextafter(cx, -INFINITY);
+    CHECK(orient2d(ax, ax, bx, bx, cx, above) > 0);
+    CHECK(orient2d(ax, ax, bx, bx, cx, below) < 0);
+    CHECK(orient2d(bx, bx, ax, ax, cx, above) < 0);
+  }
+
+  // The filtered signs agree with the exact ones
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<double> pos(-1, 1);
+  for (int i = 0; i < 10000; i++) {
+    double ax = pos(gen), ay = pos(gen), bx = pos(gen), by = pos(gen);
+    double t = pos(gen);
+    double cx = ax + t * (bx - ax), cy = ay + t * (by - ay);
+    double fast = orient2d(ax, ay, bx, by, cx, cy);
+    double exact = orient2dExact(ax, ay, bx, by, cx, cy);
+    CHECK((fast > 0) == (exact > 0) && (fast < 0) == (exact < 0));
+  }
+}
+
+// ==========================================================================
+// Segments
+// ==========================================================================
+
+static void checkSegments() {
+  for (double scale : {1E-6, 1.0, 1E6}) {
+    // Crossing in the middle of both segments
+    CHECK(segmentsCross(0, 0, scale, scale, 0, scale, scale, 0));
+
+    // Collinear, overlapping or not
+    CHECK(!segmentsCross(0, 0, 2 * scale, 0, scale, 0, 3 * scale, 0));
+    CHECK(!segmentsCross(0, 0, scale, 0, 2 * scale, 0, 3 * scale, 0));
+
+    // Parallel, one ulp apart
+    double y = std::nextafter(0.0, 1.0);
+    CHECK(!segmentsCross(0, 0, scale, 0, 0, y, scale, y));
+
+    // Crossing in the middle under a small angle, or under an angle below
+    // PARALLEL_SINE as the two copies of a shared edge
+    double d = scale * 1E-6;
+    CHECK(segmentsCross(0, -d, scale, d, 0, d, scale, -d));
+    d = scale * 1E-12;
+    CHECK(!segmentsCross(0, -d, scale, d, 0, d, scale, -d));
+
+    // Sharing a vertex, or touching within the vertex window
+    CHECK(!segmentsCross(0, 0, scale, 0, 0, 0, 0, scale));
+    CHECK(!segmentsCross(0, 0, scale, 0, scale * 1E-4, -scale,
+                         scale * 1E-4, scale));
+  }
+
+  // The answer does not depend on the order of the segments
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> pos(0, 1);
+  for (int i = 0; i < 10000; i++) {
+    double c[8];
+    for (double &v : c)
+      v = pos(gen);
+    CHECK(segmentsCross(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]) ==
+          segmentsCross(c[4], c[5], c[6], c[7], c[0], c[1], c[2], c[3]));
+  }
+}
+
+// ==========================================================================
+// Polygons
+// ==========================================================================
+
+static void checkPolygons() {
+  EdgeBlock big = makePolygon({at(0, 0), at(10, 0), at(0, 10)});
+  EdgeBlock small = makePolygon({at(1, 1), at(2, 1), at(1, 2)});
+  EdgeBlock apart = makePolygon({at(20, 0), at(30, 0), at(20, 10)});
+
+  // Triangle fully inside another, no edge crossing
+  CHECK(!big.isCrossedBy(Edge(at(1, 1), at(2, 1))));
+  CHECK(big.overlaps(small));
+  CHECK(small.overlaps(big));
+  CHECK(!big.overlaps(apart));
+
+  // Locations
+  CHECK(big.locate(1, 1) == Location::INSIDE);
+  CHECK(big.locate(20, 20) == Location::OUTSIDE);
+  CHECK(big.locate(5, 0) == Location::BOUNDARY);
+  CHECK(big.locate(5, 5) == Location::BOUNDARY);
+  Vertex inner = small.getInnerPoint();
+  CHECK(small.locate(inner(0), inner(1)) == Location::INSIDE);
+
+  // Stacked identical facets, in both orientations
+  CHECK(big.overlaps(makePolygon({at(0, 0), at(10, 0), at(0, 10)})));
+  CHECK(big.overlaps(makePolygon({at(0, 10), at(10, 0), at(0, 0)})));
+
+  // Facets sharing an edge, with some noise on the shared vertices
+  for (double noise : {0.0, 1E-12, -1E-9}) {
+    EdgeBlock left = makePolygon({at(0, 0), at(0, 10), at(-5, 5)});
+    EdgeBlock right = makePolygon(
+        {at(noise, 10 - noise), at(-noise, noise), at(5, 5)});
+    CHECK(!left.overlaps(right));
+    CHECK(!right.overlaps(left));
+  }
+
+  // Facets sharing a vertex only
+  CHECK(!big.overlaps(makePolygon({at(10, 0), at(20, 0), at(20, 5)})));
+}
+
+// ==========================================================================
+// Edge block kernels
+// ==========================================================================
+
+static void checkKernels() {
+  // Random edges, with shared vertices and collinear ones on a coarse lattice
+  std::mt19937 gen(13);
+  std::uniform_int_distribution<int> lattice(0, 8);
+  std::uniform_real_distribution<double> pos(0, 8);
+  std::vector<Edge> edges;
+  for (int i = 0; i < 2 * (int)EdgeBlock::MASK_SIZE + 13; i++) {
+    if (i % 2 == 0)
+      edges.push_back(Edge(at(lattice(gen), lattice(gen)),
+                           at(lattice(gen), lattice(gen))));
+    else
+      edges.push_back(Edge(at(pos(gen), pos(gen)), at(pos(gen), pos(gen))));
+  }
+  EdgeBlock block;
+  for (const Edge &edge : edges)
+    block.push_back(edge);
+
+  for (const Edge &edge : edges) {
+    for (bool strict : {false, true}) {
+      for (size_t first = 0; first < block.size();
+           first += EdgeBlock::MASK_SIZE) {
+        size_t n = std::min(EdgeBlock::MASK_SIZE, block.size() - first);
+        uint64_t expected = 0;
+        for (size_t j = 0; j < n; j++) {
+          if (segmentsCross(edge, edges[first + j], strict))
+            expected |= (uint64_t)1 << j;
+        }
+        CHECK(block.getCrossings(edge, first, n, strict) == expected);
+      }
+    }
+  }
+}
+
+int main() {
+  checkOrientation();
+  checkSegments();
+  checkPolygons();
+  checkKernels();
+  std::cout << ((failures == 0) ? "All checks passed" : "Some checks failed")
+            << std::endl;
+  return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -2,12 +2,14 @@
 #define KAMI_ARGUMENTS
 
 #include "kami/global/logging.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <iostream>
 #include <ostream>
 #include <sstream>
 #include <string>
+#include <thread>
 
 namespace kami::args {
 
@@ -25,6 +27,9 @@ inline void printHelp() {
       << std::endl;
   std::cout << "\t-d: maximum recursive depth (for debug purposes)"
             << std::endl;
+  std::cout << "\t-j: number of threads (0 for all the cores)" << std::endl;
+  std::cout << "\t-c: slicing mode, greedy (default) or mincut" << std::endl;
+  std::cout << "\t-p: packing engine, tprf (default) or maxrects" << std::endl;
   std::cout << "\t-h: show this help" << std::endl;
 }
 
@@ -33,10 +38,35 @@ constexpr char ARG_OUTPUT[]{"-o"};
 constexpr char ARG_WORLD_SCALING[]{"-s"};
 constexpr char ARG_RESOLUTION[]{"-f"};
 constexpr char ARG_MAX_DEPTH[]{"-d"};
+constexpr char ARG_THREADS[]{"-j"};
+constexpr char ARG_SLICING[]{"-c"};
+constexpr char ARG_PACKING[]{"-p"};
 constexpr char ARG_SVG_DEBUG[]{"-svgdbg"};
 constexpr char ARG_HELP[]{"-h"};
 
-enum class Arg { NONE, INPUT, OUTPUT, W_SCALING, RESOLUTION, MAX_DEPTH };
+enum class Arg {
+  NONE,
+  INPUT,
+  OUTPUT,
+  W_SCALING,
+  RESOLUTION,
+  MAX_DEPTH,
+  THREADS,
+  SLICING,
+  PACKING
+};
+
+/**
+ * @brief How the parts are cut: facet by facet while walking the tree, or with
+ * the smallest set of cuts over all the overlaps
+ */
+enum class SlicingMode { GREEDY, MIN_CUT };
+
+/**
+ * @brief How the parts are put on the sheets: the Touch Parameter heuristic
+ * scoring every corner, or the faster MaxRects one
+ */
+enum class PackingEngine { TP_RF, MAX_RECTS };
 
 constexpr long NO_REC_LIMIT{-1};
 struct Args {
@@ -51,6 +81,15 @@ struct Args {
   // Debug
   int max_depth = NO_REC_LIMIT;
 
+  // Parallelism
+  int n_threads = 1;
+
+  // Slicing
+  SlicingMode slicing = SlicingMode::GREEDY;
+
+  // Packing
+  PackingEngine packing = PackingEngine::TP_RF;
+
   bool askHelp = false;
   bool svg_debug = false;
 
@@ -61,6 +100,13 @@ struct Args {
     os << "\tScale : " << Args::printAsScale(args.world_scaling) << std::endl;
     os << "\tResolution : " << args.resolution << std::endl;
     os << "\tMax depth : " << args.max_depth << std::endl;
+    os << "\tThreads : " << args.n_threads << std::endl;
+    os << "\tSlicing : "
+       << ((args.slicing == SlicingMode::MIN_CUT) ? "mincut" : "greedy")
+       << std::endl;
+    os << "\tPacking : "
+       << ((args.packing == PackingEngine::MAX_RECTS) ? "maxrects" : "tprf")
+       << std::endl;
     return os;
   }
 
@@ -107,6 +153,29 @@ inline Args getArguments(int argc, char **argv) {
     case Arg::MAX_DEPTH:
       args.max_depth = std::stoi(arg);
       break;
+    case Arg::THREADS:
+      args.n_threads = std::stoi(arg);
+      if (args.n_threads <= 0)
+        args.n_threads = std::max(1u, std::thread::hardware_concurrency());
+      break;
+    case Arg::SLICING:
+      if (strcmp(arg, "mincut") == 0)
+        args.slicing = SlicingMode::MIN_CUT;
+      else if (strcmp(arg, "greedy") == 0)
+        args.slicing = SlicingMode::GREEDY;
+      else
+        std::cout << "Unknown slicing mode " << arg << ", using greedy"
+                  << std::endl;
+      break;
+    case Arg::PACKING:
+      if (strcmp(arg, "maxrects") == 0)
+        args.packing = PackingEngine::MAX_RECTS;
+      else if (strcmp(arg, "tprf") == 0)
+        args.packing = PackingEngine::TP_RF;
+      else
+        std::cout << "Unknown packing engine " << arg << ", using tprf"
+                  << std::endl;
+      break;
     default:
       break;
     }
@@ -123,6 +192,12 @@ inline Args getArguments(int argc, char **argv) {
       next = Arg::RESOLUTION;
     else if (strcmp(arg, ARG_MAX_DEPTH) == 0)
       next = Arg::MAX_DEPTH;
+    else if (strcmp(arg, ARG_THREADS) == 0)
+      next = Arg::THREADS;
+    else if (strcmp(arg, ARG_SLICING) == 0)
+      next = Arg::SLICING;
+    else if (strcmp(arg, ARG_PACKING) == 0)
+      next = Arg::PACKING;
     else if (strcmp(arg, ARG_HELP) == 0)
       args.askHelp = true;
     else if (strcmp(arg, ARG_SVG_DEBUG) == 0)
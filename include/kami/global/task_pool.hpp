@@ -0,0 +1,87 @@
+#ifndef KAMI_TASK_POOL
+#define KAMI_TASK_POOL
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kami {
+
+// ==========================================================================
+// Work-stealing task pool
+// ==========================================================================
+
+/**
+ * @brief Pool of threads running tasks that can spawn other tasks.
+ *
+ * Each worker has its own queue: it pushes and pops the tasks it spawns at the
+ * back of it (depth first, as a serial recursion would do), and steals from
+ * the front of the other queues when its own is empty. The thread calling
+ * run() is the worker 0.
+ */
+class TaskPool {
+public:
+  typedef std::function<void()> Task;
+
+  /**
+   * @brief Create the pool
+   *
+   * @param n_threads the number of workers, including the calling thread
+   */
+  TaskPool(size_t n_threads);
+  ~TaskPool();
+
+  size_t size() const { return queues.size(); }
+
+  /**
+   * @brief Add a task to the queue of the current worker. Should be called
+   * from a task, or before run().
+   */
+  void submit(Task task);
+
+  /**
+   * @brief Run the given task on the pool and wait for it and all the tasks
+   * it spawned to end.
+   */
+  void run(Task root);
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief Get the next task for the given worker, from its own queue first,
+   * else stolen from another one.
+   */
+  bool pop(size_t worker, Task &task);
+
+  /**
+   * @brief Run the task and signal the end of the last pending one
+   */
+  void execute(Task &task);
+
+  /**
+   * @brief Loop of the spawned workers
+   */
+  void work(size_t worker);
+
+  std::vector<std::unique_ptr<Queue>> queues; //< One queue per worker
+  std::vector<std::thread> threads;           //< Workers 1 to N-1
+
+  std::atomic<size_t> queued{0};  //< Tasks waiting in the queues
+  std::atomic<size_t> pending{0}; //< Tasks submitted and not yet ended
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  bool stopping = false;
+};
+
+} // namespace kami
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef KAMI_IO_MAPPED_FILE
+#define KAMI_IO_MAPPED_FILE
+
+#include <cstddef>
+#include <string>
+
+namespace kami::io {
+
+/**
+ * @brief Read-only memory mapping of a whole file. The mapping is released
+ * when the object is destroyed.
+ */
+class MappedFile {
+public:
+  MappedFile() {}
+  MappedFile(const std::string &path) { open(path); }
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Map the given file in memory.
+   *
+   * @param path the path of the file to map
+   * @return true if the file is mapped
+   * @return false if it couldn't be opened or mapped
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief Release the mapping (if any)
+   */
+  void close();
+
+  bool isOpen() const { return _data != nullptr; }
+  const char *data() const { return static_cast<const char *>(_data); }
+  size_t size() const { return _size; }
+
+private:
+  void *_data = nullptr;
+  size_t _size = 0;
+};
+
+} // namespace kami::io
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef KAMI_IO_STL_READER
+#define KAMI_IO_STL_READER
+
+#include "kami/io/mapped_file.hpp"
+#include "microstl/microstl.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace kami::io {
+
+// ==========================================================================
+// Facet record
+// ==========================================================================
+
+/**
+ * @brief A facet as laid out in a binary STL record (the normal then the three
+ * vertices), without the trailing attribute bytes.
+ */
+struct StlFacet {
+  float n[3];
+  float v1[3];
+  float v2[3];
+  float v3[3];
+};
+static_assert(sizeof(StlFacet) == 48, "StlFacet must match the STL record");
+
+// ==========================================================================
+// STL Mesh
+// ==========================================================================
+
+/**
+ * @brief Facets of an STL file, ready to be handed to the pool builder.
+ *
+ * Binary files are memory-mapped and their records are viewed in place: no
+ * copy of the facets is made before the pool reads them. ASCII files are
+ * parsed in parallel into a contiguous facet buffer.
+ */
+class StlMesh {
+public:
+  static constexpr size_t BINARY_HEADER_SIZE{80};
+  static constexpr size_t BINARY_PREAMBLE_SIZE{BINARY_HEADER_SIZE + 4};
+  static constexpr size_t BINARY_RECORD_SIZE{50};
+
+  static constexpr size_t ASCII_CHUNK_SIZE{1 << 20}; //< Min bytes per thread
+  static constexpr size_t ASCII_FACET_SIZE_HINT{256}; //< Bytes per facet
+
+  /**
+   * @brief Load the given STL file.
+   *
+   * @param path the path of the STL file
+   * @return microstl::Result::Success if the facets are available
+   */
+  microstl::Result load(const std::string &path);
+
+  size_t size() const { return _count; }
+  bool isAscii() const { return _ascii; }
+
+  /**
+   * @brief Get the facet at the given index. Binary records are only 2-bytes
+   * aligned inside the file, so the floats are copied out of the mapping.
+   */
+  inline StlFacet operator[](size_t i) const {
+    if (_records == nullptr)
+      return _parsed[i];
+    StlFacet facet;
+    std::memcpy(&facet, _records + i * BINARY_RECORD_SIZE, sizeof(StlFacet));
+    return facet;
+  }
+
+private:
+  /**
+   * @brief Check whether the mapped file looks like an ASCII STL file. A file
+   * whose size matches exactly the binary facet count is always binary, even
+   * if its header starts with "solid".
+   */
+  bool isAsciiFile() const;
+
+  /**
+   * @brief Validate the binary preamble against the file size and make the
+   * view on the facet records.
+   */
+  microstl::Result loadBinary();
+
+  /**
+   * @brief Parse the ASCII file into the facet buffer. The buffer is split on
+   * "facet normal" boundaries, the chunks are parsed concurrently and then
+   * merged back in the file order.
+   */
+  microstl::Result loadAscii();
+
+  MappedFile _file;
+  const char *_records = nullptr; //< View on the binary records
+  size_t _count = 0;              //< Number of facets
+  std::vector<StlFacet> _parsed;  //< Facets parsed from an ASCII file
+  bool _ascii = false;
+};
+
+} // namespace kami::io
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef KAMI_MATH_TYPES
 #define KAMI_MATH_TYPES
 
+#include <cstdint>
 #include <eigen3/Eigen/Eigen>
 
 namespace kami::math {
@@ -12,7 +13,9 @@ namespace kami::math {
 typedef unsigned long ulong;
 typedef Eigen::Vector<double, 3> Vec3;
 typedef Eigen::Vector<double, 4> Vec4;
+typedef Eigen::Matrix<double, 3, 3> Mat3;
 typedef Eigen::Matrix<double, 4, 4> Mat4;
+typedef uint32_t VertexId;
 
 // ==========================================================================
 // Constants
@@ -21,6 +24,7 @@ typedef Eigen::Matrix<double, 4, 4> Mat4;
 constexpr double SIMPLIFICATION_THRESHOLD(1E-6);
 constexpr double MAX_DISTANCE{1E-3};
 constexpr double MAX_DISTANCE2{MAX_DISTANCE * MAX_DISTANCE};
+constexpr VertexId NO_VERTEX{UINT32_MAX};
 
 } // namespace kami::math
 
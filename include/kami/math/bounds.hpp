@@ -23,6 +23,18 @@ struct Bounds {
       : xmin(_xmin), xmax(_xmax), ymin(_ymin), ymax(_ymax), zmin(_ymin),
         zmax(_ymax) {}
 
+  /**
+   * @brief Grow the bounds by the given ratio of their coordinates
+   */
+  void pad(double padding) {
+    xmin += ((xmin < 0) ? 1 : -1) * padding * xmin;
+    xmax += ((xmax < 0) ? -1 : 1) * padding * xmax;
+    ymin += ((ymin < 0) ? 1 : -1) * padding * ymin;
+    ymax += ((ymax < 0) ? -1 : 1) * padding * ymax;
+    zmin += ((zmin < 0) ? 1 : -1) * padding * zmin;
+    zmax += ((zmax < 0) ? -1 : 1) * padding * zmax;
+  }
+
   Bounds &operator+=(const Bounds &other) {
     // X
     if (other.xmin < this->xmin)
@@ -14,6 +14,7 @@ struct IntersectParams {
 struct Edge {
 public:
   static constexpr float VERTEX_AREA{1E-3};
+  static constexpr double PARALLEL_SINE{1E-9}; //< Angle of colinear edges
 
   Edge(const Vertex &_v1, const Vertex &_v2) : v1(_v1), v2(_v2) {}
   Edge() : v1(Vertex(0, 0, 0)), v2(Vertex(0, 0, 0)) {}
@@ -75,21 +76,12 @@ public:
   // Utils for exporting
   // ==========================================================================
 
-  /**
-   * @brief Compute on how much distance the two egdes are overlapping. Consider
-   * that the edges are horizontal or vertical only.
-   *
-   * @param e1 the first edge
-   * @param e2 the second edge
-   * @return double the distance of overlapping
-   */
-  static double overlapsLength(const Edge &e1, const Edge &e2);
-
   /**
    * @brief Find the intersection between two edges. The method used here is
    * finding the parameters for both direction vector of the edges. The
    * intersection P is then at P = s*v1.dir() = t*v2.dir(). If the vectors are
-   * colinear, the function return (-1, -1).
+   * colinear (the sine of their angle below PARALLEL_SINE), the function
+   * return (-1, -1). See math::segmentsCross for a robust crossing test.
    *
    * @param v1 the first edge
    * @param v2 the second edge
@@ -0,0 +1,102 @@
+#ifndef KAMI_MATH_EDGE_BLOCK
+#define KAMI_MATH_EDGE_BLOCK
+
+#include "kami/math/edge.hpp"
+#include "kami/math/predicates.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami::math {
+
+// ==========================================================================
+// Edge block
+// ==========================================================================
+
+/**
+ * @brief 2D edges stored as separate arrays of coordinates, so that one edge
+ * can be tested against several of them at once.
+ *
+ * The crossing tests give the same result as math::segmentsCross, the edge
+ * tested being its first segment. The orientations are computed four edges at
+ * a time with AVX (KAMI_AVX build option), two at a time with SSE2 otherwise,
+ * and only the edges whose signs are uncertain are tested again one by one
+ * with exact arithmetic.
+ *
+ * When the edges follow the boundary of a facet, each one starting at the end
+ * of the previous one, the block is also a closed polygon for the location
+ * tests.
+ */
+struct EdgeBlock {
+  static constexpr size_t MASK_SIZE{64}; //< Edges in one hit mask
+  static constexpr double INNER_BAND{Edge::VERTEX_AREA}; //< Boundary width
+
+  std::vector<double> x1, y1; //< First vertex of each edge
+  std::vector<double> x2, y2; //< Second vertex of each edge
+
+  size_t size() const { return x1.size(); }
+
+  void clear() {
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+  }
+
+  void push_back(const Edge &edge) {
+    const Vertex &v1 = edge.getFirst(), &v2 = edge.getSecond();
+    x1.push_back(v1(0));
+    y1.push_back(v1(1));
+    x2.push_back(v2(0));
+    y2.push_back(v2(1));
+  }
+
+  // ==========================================================================
+  // Crossings
+  // ==========================================================================
+
+  /**
+   * @brief Get the edges [first, first + n) crossed by the given one, away
+   * from their vertices. The bit i of the mask is set when the edge first + i
+   * is crossed.
+   *
+   * @param edge the edge to test
+   * @param first the first edge of the block to test
+   * @param n the number of edges to test, at most MASK_SIZE
+   * @param strict true to exclude the bounds of the parameter window
+   */
+  uint64_t getCrossings(const Edge &edge, size_t first, size_t n,
+                        bool strict = false) const;
+
+  /**
+   * @brief Test whether the given edge crosses one of the edges of the block,
+   * away from their vertices
+   */
+  bool isCrossedBy(const Edge &edge, bool strict = false) const;
+
+  // ==========================================================================
+  // Polygon
+  // ==========================================================================
+
+  /**
+   * @brief Locate a point relative to the polygon of the block. The points
+   * closer to an edge than INNER_BAND times its length are on the boundary,
+   * the others are located with exact orientations.
+   */
+  Location locate(double px, double py) const;
+
+  /**
+   * @brief Get a point inside the polygon of the block, far from its boundary:
+   * the centroid of one of its ears.
+   */
+  Vertex getInnerPoint() const;
+
+  /**
+   * @brief Test whether the polygons of the two blocks overlap: either two of
+   * their edges cross, or one polygon lies inside the other one.
+   */
+  bool overlaps(const EdgeBlock &other) const;
+};
+
+} // namespace kami::math
+
+#endif
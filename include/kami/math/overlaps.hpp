@@ -6,40 +6,120 @@
 
 namespace kami::overlaps {
 
+/**
+ * @brief Overlapping between two triangles, stored with id1 <= id2 so that the
+ * two orders of a pair are the same overlap
+ */
 struct Overlap {
   ulong id1, id2;
 
+  Overlap(ulong a, ulong b) : id1((a < b) ? a : b), id2((a < b) ? b : a) {}
+
   inline bool operator==(const Overlap &other) const {
-    return ((id1 == other.id1 && id2 == other.id2) ||
-            (id1 == other.id2 && id2 == other.id1));
+    return id1 == other.id1 && id2 == other.id2;
+  }
+  inline bool operator<(const Overlap &other) const {
+    return (id1 < other.id1) || (id1 == other.id1 && id2 < other.id2);
   }
 };
 
 /**
- * @brief Define a list of overlapping between triangles
+ * @brief Define a set of overlapping between triangles, as a sorted vector
+ * without duplicates. The set operations are linear merges done in place.
  */
-struct MeshOverlaps : std::vector<Overlap> {
-  MeshOverlaps() : std::vector<Overlap>(0) {}
-  MeshOverlaps(const MeshOverlaps &other) : std::vector<Overlap>(other) {}
+struct MeshOverlaps {
+  typedef std::vector<Overlap>::const_iterator const_iterator;
+
+  size_t size() const { return pairs.size(); }
+  bool empty() const { return pairs.empty(); }
+  const_iterator begin() const { return pairs.begin(); }
+  const_iterator end() const { return pairs.end(); }
+
+  /**
+   * @brief Empty the set, keeping its storage
+   */
+  void clear() { pairs.clear(); }
+
+  /**
+   * @brief Add an overlap to the set. Adding them in increasing order is done
+   * in constant time.
+   */
+  void insert(const Overlap &overlap);
+
+  /**
+   * @brief Test whether the two sets have an overlap in common
+   */
+  bool meets(const MeshOverlaps &other) const;
+
+  /**
+   * @brief Add the overlaps of the other set to this one (no double)
+   */
+  MeshOverlaps &operator+=(const MeshOverlaps &other);
+
+  /**
+   * @brief Remove the overlaps of the other set from this one
+   */
+  MeshOverlaps &operator-=(const MeshOverlaps &other);
+
+  /**
+   * @brief Keep only the overlaps which are in the other set
+   */
+  MeshOverlaps &operator/=(const MeshOverlaps &other);
 
   /**
    * @brief Return the intersection between the two overlapping list.
    */
-  MeshOverlaps operator/(const MeshOverlaps &other) const;
+  MeshOverlaps operator/(const MeshOverlaps &other) const {
+    return MeshOverlaps(*this) /= other;
+  }
 
   /**
    * @brief Return the sum of the two overlaps (no double)
    */
-  MeshOverlaps operator+(const MeshOverlaps &other) const;
+  MeshOverlaps operator+(const MeshOverlaps &other) const {
+    return MeshOverlaps(*this) += other;
+  }
 
   /**
    * @brief Return the overlaps minus the elements in the other overlaps.
    */
-  MeshOverlaps operator-(const MeshOverlaps &other) const;
+  MeshOverlaps operator-(const MeshOverlaps &other) const {
+    return MeshOverlaps(*this) -= other;
+  }
 
   friend std::ostream &operator<<(std::ostream &os, MeshOverlaps &overlaps);
+
+private:
+  std::vector<Overlap> pairs;
+};
+
+// ==========================================================================
+// Storage pool
+// ==========================================================================
+
+/**
+ * @brief Recycle the storage of the overlap sets: a released set keeps its
+ * capacity and is given back, empty, by the next acquire.
+ */
+class OverlapsPool {
+public:
+  MeshOverlaps acquire() {
+    if (free.empty())
+      return MeshOverlaps();
+    MeshOverlaps out = std::move(free.back());
+    free.pop_back();
+    return out;
+  }
+
+  void release(MeshOverlaps &&overlaps) {
+    overlaps.clear();
+    free.push_back(std::move(overlaps));
+  }
+
+private:
+  std::vector<MeshOverlaps> free;
 };
 
 } // namespace kami::overlaps
 
-#endif
\ No newline at end of file
+#endif
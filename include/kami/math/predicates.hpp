@@ -0,0 +1,85 @@
+#ifndef KAMI_MATH_PREDICATES
+#define KAMI_MATH_PREDICATES
+
+#include "kami/math/edge.hpp"
+#include <limits>
+
+namespace kami::math {
+
+// ==========================================================================
+// Orientation
+// ==========================================================================
+
+/**
+ * @brief Bound of the rounding error of the floating-point orientation,
+ * relative to the sum of the magnitudes of its two products (Shewchuk).
+ */
+constexpr double ORIENT_ERROR{
+    (3.0 + 16.0 * (std::numeric_limits<double>::epsilon() / 2)) *
+    (std::numeric_limits<double>::epsilon() / 2)};
+
+/**
+ * @brief Compute the orientation of c relative to the line going from a to b,
+ * as twice the signed area of the triangle (a, b, c). Positive when c is on the
+ * left, negative when it is on the right, zero when the points are aligned.
+ *
+ * The floating-point result is used when its sign is certain. Otherwise, the
+ * orientation is computed again with exact arithmetic. The sign of the result
+ * is thus always exact, and its magnitude is close to the exact one.
+ */
+double orient2d(double ax, double ay, double bx, double by, double cx,
+                double cy);
+
+/**
+ * @brief Compute the orientation of c relative to the line going from a to b
+ * with exact arithmetic. Same convention as orient2d.
+ */
+double orient2dExact(double ax, double ay, double bx, double by, double cx,
+                     double cy);
+
+// ==========================================================================
+// Segments
+// ==========================================================================
+
+/**
+ * @brief Square of the sine of the angle under which two segments are colinear
+ */
+constexpr double PARALLEL_SINE2{Edge::PARALLEL_SINE * Edge::PARALLEL_SINE};
+
+/**
+ * @brief Test whether the segment (a, b) crosses the segment (c, d), away from
+ * their vertices.
+ *
+ * The sides of the crossing are decided with exact orientations, so that
+ * parallel and almost parallel segments get a reliable answer. Segments whose
+ * angle has a sine below PARALLEL_SINE are colinear and never cross, which
+ * ignores the edges shared by two facets whose vertices are not exactly the
+ * same. The crossing is then kept only when it lies in the VERTEX_AREA window
+ * of both segments, a tolerance relative to their lengths which ignores the
+ * vertices shared by two facets. The answer is the same with the two segments
+ * swapped.
+ *
+ * @param strict true to exclude the bounds of the window
+ */
+bool segmentsCross(double ax, double ay, double bx, double by, double cx,
+                   double cy, double dx, double dy, bool strict = false);
+
+inline bool segmentsCross(const Edge &e1, const Edge &e2,
+                          bool strict = false) {
+  const Vertex &a = e1.getFirst(), &b = e1.getSecond();
+  const Vertex &c = e2.getFirst(), &d = e2.getSecond();
+  return segmentsCross(a(0), a(1), b(0), b(1), c(0), c(1), d(0), d(1), strict);
+}
+
+// ==========================================================================
+// Polygons
+// ==========================================================================
+
+/**
+ * @brief Location of a point relative to a polygon
+ */
+enum class Location { OUTSIDE, BOUNDARY, INSIDE };
+
+} // namespace kami::math
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef KAMI_MATH_RIGID_TRSF
+#define KAMI_MATH_RIGID_TRSF
+
+#include "kami/math/base_types.hpp"
+#include <cmath>
+#include <ostream>
+
+namespace kami::math {
+
+// ==========================================================================
+// Rigid transformation
+// ==========================================================================
+
+/**
+ * @brief Rigid transformation with an optional uniform scaling, applied to a
+ * point as p -> s * R * p + t.
+ *
+ * Composing two of them only needs a 3x3 product, and the inverse is given in
+ * closed form (R^T, -R^T * t / s) instead of a general 4x4 inversion.
+ */
+struct RigidTrsf {
+  Mat3 R = Mat3::Identity(); //< Rotation
+  Vec3 t = Vec3::Zero();     //< Translation
+  double s = 1;              //< Uniform scaling
+
+  static RigidTrsf translation(const Vec3 &t) {
+    RigidTrsf out;
+    out.t = t;
+    return out;
+  }
+
+  static RigidTrsf scaling(double s) {
+    RigidTrsf out;
+    out.s = s;
+    return out;
+  }
+
+  /**
+   * @brief Compose the two transformations, the other being applied first
+   */
+  RigidTrsf operator*(const RigidTrsf &other) const {
+    RigidTrsf out;
+    out.R = R * other.R;
+    out.t = s * (R * other.t) + t;
+    out.s = s * other.s;
+    return out;
+  }
+
+  RigidTrsf inverse() const {
+    RigidTrsf out;
+    out.R = R.transpose();
+    out.s = 1 / s;
+    out.t = -out.s * (out.R * t);
+    return out;
+  }
+
+  inline Vec3 apply(const Vec3 &point) const { return s * (R * point) + t; }
+
+  /**
+   * @brief Test whether the transformation keeps the axes, so that it maps an
+   * axis-aligned box on the box of the moved points
+   */
+  inline bool isAxisAligned() const {
+    return (s > 0) && (R == Mat3::Identity());
+  }
+
+  /**
+   * @brief Apply the rotation only, for directions and normals
+   */
+  inline Vec3 rotate(const Vec3 &dir) const { return R * dir; }
+
+  friend std::ostream &operator<<(std::ostream &os, const RigidTrsf &trsf) {
+    os << "R = [" << trsf.R.row(0) << "; " << trsf.R.row(1) << "; "
+       << trsf.R.row(2) << "], t = [" << trsf.t.transpose()
+       << "], s = " << trsf.s;
+    return os;
+  }
+};
+
+// ==========================================================================
+// Planar placement
+// ==========================================================================
+
+/**
+ * @brief Rigid transformation of the plane, applied to a point as
+ * (u, v) -> t + u * (c, s) + v * (-s, c).
+ */
+struct Rigid2D {
+  double c = 1, s = 0;   //< Cosine and sine of the rotation
+  double tx = 0, ty = 0; //< Translation
+
+  /**
+   * @brief Placement putting the origin on a and the X axis along a -> b.
+   * Falls back on the world X axis if the two points are the same.
+   */
+  static Rigid2D alongSegment(double ax, double ay, double bx, double by) {
+    Rigid2D out;
+    double dx = bx - ax, dy = by - ay;
+    double norm = std::sqrt(dx * dx + dy * dy);
+    if (norm > 0) {
+      out.c = dx / norm;
+      out.s = dy / norm;
+    }
+    out.tx = ax;
+    out.ty = ay;
+    return out;
+  }
+
+  inline double applyX(double u, double v) const { return tx + c * u - s * v; }
+  inline double applyY(double u, double v) const { return ty + s * u + c * v; }
+
+  friend std::ostream &operator<<(std::ostream &os, const Rigid2D &trsf) {
+    os << "R = [" << trsf.c << " " << -trsf.s << "; " << trsf.s << " "
+       << trsf.c << "], t = [" << trsf.tx << " " << trsf.ty << "]";
+    return os;
+  }
+};
+
+} // namespace kami::math
+
+#endif
@@ -16,6 +16,7 @@ struct Vertex : public Vec4 {
       : Vec4{mvertex.x, mvertex.y, mvertex.z, 1} {}
   Vertex(microstl::Normal &mnormal)
       : Vec4{mnormal.x, mnormal.y, mnormal.z, 1} {}
+  Vertex(const float v[3]) : Vec4{v[0], v[1], v[2], 1} {}
   Vertex(double x, double y, double z, double w = 1) : Vec4{x, y, z, w} {}
   Vertex(const Vec4 &other) : Vec4(other) {}
 
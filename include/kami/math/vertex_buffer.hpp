@@ -0,0 +1,85 @@
+#ifndef KAMI_MATH_VERTEX_BUFFER
+#define KAMI_MATH_VERTEX_BUFFER
+
+#include "kami/math/bounds.hpp"
+#include "kami/math/rigid_trsf.hpp"
+#include "kami/math/vertex.hpp"
+#include <vector>
+
+namespace kami::math {
+
+// ==========================================================================
+// Vertex buffer
+// ==========================================================================
+
+/**
+ * @brief Positions of a set of points, stored as separate x, y and z arrays.
+ *
+ * Transforms and bounds are computed as linear sweeps over a range of the
+ * buffer, so that a polygon stored on contiguous points is processed without
+ * any indirection.
+ */
+struct VertexBuffer {
+  std::vector<double> x, y, z;
+
+  size_t size() const { return x.size(); }
+
+  void reserve(size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+  }
+
+  void push_back(const Vertex &v) {
+    x.push_back(v(0));
+    y.push_back(v(1));
+    z.push_back(v(2));
+  }
+
+  inline Vertex get(size_t i) const { return Vertex(x[i], y[i], z[i]); }
+
+  /**
+   * @brief Get the point i moved by the given transformation, the buffer
+   * being left untouched
+   */
+  inline Vertex get(size_t i, const RigidTrsf &trsf) const {
+    Vec3 p = trsf.apply(Vec3{x[i], y[i], z[i]});
+    return Vertex(p(0), p(1), p(2));
+  }
+
+  /**
+   * @brief Apply the given transformation to the points [first, first + n)
+   */
+  void transform(const RigidTrsf &trsf, size_t first, size_t n);
+
+  /**
+   * @brief Express the points [first, first + n) in the 2D frame (origin,
+   * x_axis, y_axis), then place them on the Z = 0 plane with the given
+   * placement.
+   */
+  void unfold(const Vec3 &origin, const Vec3 &x_axis, const Vec3 &y_axis,
+              const Rigid2D &place, size_t first, size_t n);
+
+  /**
+   * @brief Get the exact extent of the points [first, first + n), without
+   * padding. The points should not be empty.
+   */
+  Bounds getExtent(size_t first, size_t n) const;
+
+  /**
+   * @brief Get the bounds needed to display the points [first, first + n),
+   * once moved by the given transformation
+   */
+  Bounds getBounds(size_t first, size_t n,
+                   const RigidTrsf &trsf = RigidTrsf()) const;
+
+  /**
+   * @brief Get the bounds needed to display the points of the given extent,
+   * once moved by the given axis-aligned transformation
+   */
+  static Bounds getBounds(const Bounds &extent, const RigidTrsf &trsf);
+};
+
+} // namespace kami::math
+
+#endif
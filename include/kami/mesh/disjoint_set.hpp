@@ -0,0 +1,57 @@
+#ifndef KAMI_MESH_DISJOINT_SET
+#define KAMI_MESH_DISJOINT_SET
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace kami {
+
+// ==========================================================================
+// Disjoint set
+// ==========================================================================
+
+/**
+ * @brief Union-find forest over the indices [0, N), with union by size and
+ * path halving.
+ */
+struct DisjointSet {
+  DisjointSet(size_t n) : parent(n), size(n, 1) {
+    std::iota(parent.begin(), parent.end(), 0);
+  }
+
+  /**
+   * @brief Get the representative of the set containing i
+   */
+  inline uint32_t find(uint32_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  }
+
+  /**
+   * @brief Join the sets containing a and b
+   *
+   * @return false if they were already in the same set
+   */
+  inline bool unite(uint32_t a, uint32_t b) {
+    a = find(a);
+    b = find(b);
+    if (a == b)
+      return false;
+    if (size[a] < size[b])
+      std::swap(a, b);
+    parent[b] = a;
+    size[a] += size[b];
+    return true;
+  }
+
+  std::vector<uint32_t> parent; //< Parent of each index in the forest
+  std::vector<uint32_t> size;   //< Size of the set of each root
+};
+
+} // namespace kami
+
+#endif
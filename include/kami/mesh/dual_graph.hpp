@@ -0,0 +1,52 @@
+#ifndef KAMI_MESH_DUAL_GRAPH
+#define KAMI_MESH_DUAL_GRAPH
+
+#include "kami/math/base_types.hpp"
+#include "kami/mesh/polygon_arena.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+class LinkedPolygon;
+
+// ==========================================================================
+// Dual graph
+// ==========================================================================
+
+/**
+ * @brief Face adjacency of a pool of polygons, stored as compressed sparse
+ * rows: the links of the face i are links[offsets[i]] to links[offsets[i+1]].
+ *
+ * Two faces are adjacent when they have an edge joining the same two welded
+ * vertices. Edges shared by more than two faces only link the first two.
+ */
+struct DualGraph {
+  /**
+   * @brief Adjacency through one edge of a face
+   */
+  struct Link {
+    uint32_t face;       //< Index of the neighbour face in the pool
+    uint32_t edge;       //< Edge of this face
+    uint32_t other_edge; //< Edge of the neighbour face
+  };
+
+  DualGraph() : offsets(1, 0) {}
+  DualGraph(const PolygonArena<LinkedPolygon> &pool);
+
+  size_t size() const { return offsets.size() - 1; }
+
+  const Link *begin(uint32_t face) const {
+    return links.data() + offsets[face];
+  }
+  const Link *end(uint32_t face) const {
+    return links.data() + offsets[face + 1];
+  }
+
+  std::vector<uint32_t> offsets;
+  std::vector<Link> links;
+};
+
+} // namespace kami
+
+#endif
@@ -17,29 +17,29 @@ using namespace out;
 // ==========================================================================
 
 /**
- * @brief Represent an edge of a polygon
+ * @brief Represent an edge of a polygon. The positions of its vertices are not
+ * stored in the edge but in the vertex buffer of the pool.
  *
  * @tparam T the mesh type
  */
-template <typename T> class LinkedEdge : public math::Edge {
+template <typename T> class LinkedEdge {
 public:
-  LinkedEdge(microstl::Vertex &_v1, microstl::Vertex &_v2) : Edge(_v1, _v2) {
-    original_norm = math::Vertex::distance(v1, v2);
-  }
-  LinkedEdge(math::Vertex &_v1, math::Vertex &_v2) : Edge(_v1, _v2) {
-    original_norm = math::Vertex::distance(v1, v2);
-  }
-  LinkedEdge(math::VertexPair &_p) : Edge(_p.first, _p.second) {
-    original_norm = math::Vertex::distance(v1, v2);
+  static constexpr uint32_t NO_MESH{UINT32_MAX};
+
+  LinkedEdge(const math::Vertex &_v1, const math::Vertex &_v2,
+             math::VertexId _id1 = math::NO_VERTEX,
+             math::VertexId _id2 = math::NO_VERTEX)
+      : id1(_id1), id2(_id2) {
+    original_norm = math::Vertex::distance(_v1, _v2);
   }
-  LinkedEdge() : Edge() {}
+  LinkedEdge() {}
 
   // ==========================================================================
   // Getters
   // ==========================================================================
   bool isOwned() const { return owned; }
   bool hasCut() const { return cutted; }
-  bool nullMesh() const { return mesh == nullptr; }
+  bool nullMesh() const { return mesh == NO_MESH; }
   void setCutted(bool cut, int cut_n = -1) {
     cutted = cut;
     if (cut) {
@@ -50,20 +50,39 @@ public:
   void setOwned(bool t) { owned = t; }
 
   void setLinkedOnChildEdge(ulong v) { linked_on_child_edge = v; }
-  ulong getLinkedOnChildEdge() { return linked_on_child_edge; }
+  ulong getLinkedOnChildEdge() const { return linked_on_child_edge; }
 
   int getCutNumber() { return cut_number; }
   void setLineStyle(LineStyle _style) { linestyle = _style; }
   void setTextRatio(double factor) { text_size *= factor; }
 
-  T *getMesh() const { return mesh; }
-  void setMesh(T *p) { mesh = p; }
+  uint32_t getMesh() const { return mesh; }
+  void setMesh(uint32_t p) { mesh = p; }
+
+  math::VertexId getFirstId() const { return id1; }
+  math::VertexId getSecondId() const { return id2; }
+
+  /**
+   * @brief Test whether the given edge joins the same two welded vertices as
+   * this one, in any direction.
+   */
+  inline bool sameAs(const LinkedEdge &other) const {
+    return ((id1 == other.id1) && (id2 == other.id2)) ||
+           ((id1 == other.id2) && (id2 == other.id1));
+  }
+
+  /**
+   * @brief Test whether the given edge is this edge in the opposite direction
+   */
+  inline bool reverseOf(const LinkedEdge &other) const {
+    return (id1 == other.id2) && (id2 == other.id1);
+  }
 
   // ==========================================================================
   // SVG Export
   // ==========================================================================
 
-  void linkEdgeAsOwner(T *p, bool unlinked) {
+  void linkEdgeAsOwner(uint32_t p, bool unlinked) {
     if (unlinked) {
       owned = true;
       linestyle = LineStyle::INNER;
@@ -71,7 +90,8 @@ public:
     mesh = p;
   }
 
-  void getAsSVGLine(std::stringstream &stream) const {
+  void getAsSVGLine(std::stringstream &stream, const math::Edge &edge) const {
+    const math::Vertex &v1 = edge.getFirst(), &v2 = edge.getSecond();
     svg::line(stream, svg::LineParams{v1(0), v1(1), v2(0), v2(1), linestyle});
 
     // Print cut number
@@ -86,20 +106,17 @@ public:
   // ==========================================================================
   // Debug for edge
   // ==========================================================================
-  friend std::ostream &operator<<(std::ostream &os, const LinkedEdge &edge) {
-    os << "Edge 1:[" << edge.v1(0) << ", " << edge.v1(1) << ", " << edge.v1(2)
-       << "], 2:[" << edge.v2(0) << ", " << edge.v2(1) << ", " << edge.v2(2)
-       << "]";
-    if (edge.mesh != nullptr) {
-      os << " ->" << ((edge.owned) ? " OWNING" : "") << " Mesh "
-         << edge.mesh->getUID() << " on its " << edge.linked_on_child_edge
-         << " edge";
+  void display(std::ostream &os, const math::Edge &geometry) const {
+    const math::Vertex &v1 = geometry.getFirst(), &v2 = geometry.getSecond();
+    os << "Edge 1:[" << v1(0) << ", " << v1(1) << ", " << v1(2) << "], 2:["
+       << v2(0) << ", " << v2(1) << ", " << v2(2) << "]";
+    if (mesh != NO_MESH) {
+      os << " ->" << ((owned) ? " OWNING" : "") << " Mesh " << mesh
+         << " on its " << linked_on_child_edge << " edge";
     }
     os << std::endl;
-    os << "\t\t\t-> " << math::Vertex::distance(edge.v1, edge.v2) << " / "
-       << edge.original_norm;
-
-    return os;
+    os << "\t\t\t-> " << math::Vertex::distance(v1, v2) << " / "
+       << original_norm;
   }
 
 private:
@@ -116,9 +133,13 @@ private:
   bool cutted = false;
   int cut_number = -1;
   double text_size = 2;
-  T *mesh = nullptr;
+  uint32_t mesh = NO_MESH; //< Index of the neighbour polygon
   ulong linked_on_child_edge = 0;
 
+  // Welded vertices ids
+  math::VertexId id1 = math::NO_VERTEX;
+  math::VertexId id2 = math::NO_VERTEX;
+
   double original_norm = 0;
 
   // Style
@@ -2,11 +2,13 @@
 #define KAMI_LINKED_POLYGON
 
 #include "kami/mesh/linked_poly.hpp"
+#include "kami/mesh/welding.hpp"
 namespace kami {
 
 struct LinkedTriangle : public LinkedPolygon {
   LinkedTriangle();
-  LinkedTriangle(microstl::Facet *facet, ulong _id);
+  LinkedTriangle(PolygonArena<LinkedPolygon> &pool, const WeldedMesh &mesh,
+                 ulong _id);
 };
 
 } // namespace kami
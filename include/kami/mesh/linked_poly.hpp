@@ -15,12 +15,17 @@
 #include "kami/math/base_types.hpp"
 #include "kami/math/bounds.hpp"
 #include "kami/math/edge.hpp"
-#include "kami/math/hmat.hpp"
+#include "kami/math/edge_block.hpp"
 #include "kami/math/overlaps.hpp"
+#include "kami/math/rigid_trsf.hpp"
+#include "kami/global/task_pool.hpp"
 #include "kami/math/vertex.hpp"
+#include "kami/mesh/dual_graph.hpp"
 #include "kami/mesh/linked_edge.hpp"
+#include "kami/mesh/overlap_graph.hpp"
+#include "kami/mesh/polygon_arena.hpp"
+#include "kami/mesh/tree_multicut.hpp"
 #include "kami/packing/box.hpp"
-#include <memory>
 #include <vector>
 
 namespace kami {
@@ -30,24 +35,88 @@ namespace kami {
 // ==========================================================================
 
 class LinkedPolygon {
-  typedef std::vector<std::shared_ptr<LinkedPolygon>> LinkedPool;
+  typedef PolygonArena<LinkedPolygon> LinkedPool;
+  typedef EdgeRange<LinkedEdge<LinkedPolygon>> Edges;
+  typedef EdgeRange<const LinkedEdge<LinkedPolygon>> ConstEdges;
 
 public:
-  LinkedPolygon(int N = 3) : n(math::Vertex(0, 0, 1, 0)) {
-    facets = std::vector<LinkedEdge<LinkedPolygon>>(N);
-  }
+  /**
+   * @brief Order of the facets of a subtree: parents before their children,
+   * or children before their parents. In both cases the children of a facet
+   * are visited in the order of its edges, as a recursion would do.
+   */
+  enum class TreeOrder { PRE_ORDER, POST_ORDER };
+
+  static constexpr uint32_t UNFOLD_GRAIN{512}; //< Min faces of a unfold task
+  static constexpr uint32_t NO_PART{UINT32_MAX};
+
+  LinkedPolygon() : n(math::Vertex(0, 0, 1, 0)) {}
 
   // ==========================================================================
   // Getters
   // ==========================================================================
 
   /**
-   * @brief Get the bounds for displaying this facet
+   * @brief Get the bounds for displaying this facet. The extent of a subtree
+   * up to the cut edges is cached on its root, and only the outdated extents
+   * are computed again.
+   */
+  const math::Bounds getBounds(const LinkedPool &pool, bool recursive,
+                               bool stop_on_cut = true) const;
+
+  /**
+   * @brief Mark the cached extent of this facet outdated, with the ones of
+   * its ancestors up to the first cut edge
    */
-  const math::Bounds getBounds(bool recursive, bool stop_on_cut = true) const;
+  void invalidateExtent(const LinkedPool &pool) const;
 
   ulong getUID() const { return uid; }
 
+  /**
+   * @brief Get the edges of this facet in the arena
+   */
+  inline Edges getEdges(LinkedPool &pool) const {
+    return pool.getEdges(first_edge, n_edges);
+  }
+  inline ConstEdges getEdges(const LinkedPool &pool) const {
+    return pool.getEdges(first_edge, n_edges);
+  }
+
+  /**
+   * @brief Get the UID of the root of the part containing this facet
+   */
+  inline uint32_t getPart() const { return (part == NO_PART) ? uid : part; }
+  inline bool isPartRoot() const { return getPart() == uid; }
+
+  /**
+   * @brief Get the transformation pending on the part of this facet, which
+   * maps the vertex buffer to the actual positions of the facet
+   */
+  inline const math::RigidTrsf &getPartTrsf(const LinkedPool &pool) const {
+    return pool[getPart()].pending;
+  }
+
+  /**
+   * @brief Get the actual position of the given corner of this facet
+   */
+  inline math::Vertex getVertex(const LinkedPool &pool, int i) const {
+    return pool.vertices.get(first_edge + i, getPartTrsf(pool));
+  }
+
+  /**
+   * @brief Get the actual positions of the given edge
+   */
+  inline math::Edge getEdgeGeometry(const LinkedPool &pool, int edge) const {
+    return math::Edge(getVertex(pool, edge),
+                      getVertex(pool, (edge + 1 == n_edges) ? 0 : edge + 1));
+  }
+
+  /**
+   * @brief Get the actual positions of all the edges of this facet
+   */
+  void getEdgeGeometries(const LinkedPool &pool,
+                         math::EdgeBlock &geometries) const;
+
   int getParentEdgeIndex() const { return parent_edge; }
 
   std::string getParentEdgeName() const { return getEdgeName(parent_edge); }
@@ -55,53 +124,95 @@ public:
   /**
    * @brief Get the barycenter of the children of this facet and itself.
    */
-  const void getBarycenter(math::Barycenter &bary, bool recursive,
-                           bool stop_on_cut = true) const;
+  const void getBarycenter(const LinkedPool &pool, math::Barycenter &bary,
+                           bool recursive, bool stop_on_cut = true) const;
 
-  void getChildUIDs(std::vector<ulong> &uids) const {
-    uids.push_back(uid);
-    for (auto &f : facets) {
-      if (!f.nullMesh() && f.isOwned() && !f.hasCut())
-        f.getMesh()->getChildUIDs(uids);
-    }
-  }
+  void getChildUIDs(const LinkedPool &pool, std::vector<ulong> &uids) const;
+
+  /**
+   * @brief Append the UIDs of the facets of the subtree rooted on this facet.
+   * The tree is walked with an explicit stack, so its depth is not limited by
+   * the call stack.
+   *
+   * @param pool the pool of facets
+   * @param subtree the vector to fill
+   * @param stop_on_cut true to not go through the cut edges
+   * @param max_depth the maximum depth of the facets (-1 for no limit)
+   * @param order the order of the facets in the vector
+   * @param sizes if given, filled with the size of the subtree of each facet
+   * appended, in the same order. In preorder, the subtree of the facet i is
+   * the range [i, i + sizes[i]).
+   */
+  void getSubtree(const LinkedPool &pool, std::vector<uint32_t> &subtree,
+                  bool stop_on_cut, long max_depth = -1,
+                  TreeOrder order = TreeOrder::PRE_ORDER,
+                  std::vector<uint32_t> *sizes = nullptr) const;
 
   // ==========================================================================
   // Transformations
   // ==========================================================================
 
   /**
-   * @brief Transform this mesh facet with the given homogenous matrix
+   * @brief Transform this mesh facet with the given transformation.
    *
-   * @param mat the homogenous matrix describing the transform
+   * A single facet is transformed in the vertex buffer. A subtree is not: its
+   * facets become a part if they were not (see makePart), and the
+   * transformation is composed with the one pending on the part.
+   *
+   * @param trsf the rigid transformation to apply
    */
-  void transform(const math::HMat &mat, bool recusive = false,
-                 bool stop_on_cut = true);
+  void transform(LinkedPool &pool, const math::RigidTrsf &trsf,
+                 bool recusive = false, bool stop_on_cut = true);
 
   /**
-   * @brief Compute recursively the transformation to put this face into the
-   * world plane and call this function on the owned children.
+   * @brief Make the subtree of this facet, up to the cut edges, a part rooted
+   * on this facet. The part starts with the transformation pending on the
+   * part the facet was in. The facet should be the root, or its parent edge
+   * should be cut, so that the parts are delimited by the cut edges.
    */
-  void unfoldMesh(long depth, long max_depth);
+  void makePart(LinkedPool &pool);
+
+  /**
+   * @brief Put the faces of the subtree into the world plane, parents first.
+   * Each face is placed from the edge shared with its already placed parent,
+   * so that the error does not accumulate along the tree.
+   *
+   * With a task pool, the child subtrees of at least UNFOLD_GRAIN faces are
+   * unfolded as separate tasks. Each face gets the same result as in the
+   * serial run.
+   */
+  void unfoldMesh(LinkedPool &pool, long depth, long max_depth,
+                  TaskPool *tasks = nullptr);
 
   // ==========================================================================
   // Linking logic
   // ==========================================================================
 
   /**
-   * @brief Search for neighbours facets in the pool and create a link to
-   * them. Get the ownership on these facets if no one is linked to them.
+   * @brief Create a link to the neighbours facets given by the dual graph. Get
+   * the ownership on these facets if no one is linked to them.
    *
    * @param pool the pool of facets of the STL file
+   * @param graph the adjacency of the pool
+   * @param index the index of this facet in the pool
    * @return std::vector<ulong> the index of the owned facets
    */
-  std::vector<ulong> linkNeighbours(LinkedPool &pool);
+  std::vector<ulong> linkNeighbours(LinkedPool &pool, const DualGraph &graph,
+                                    uint32_t index);
 
   /**
-   * @brief Merge the facets with owned child facets with the same normal
+   * @brief Merge the adjacent facets of the pool that have the same normal.
+   *
+   * The facets sharing an edge in opposite directions are joined in a
+   * disjoint-set, then the boundary of each region is traced from the edges
+   * that do not cancel with an edge of the same region. Regions whose boundary
+   * is not a single simple loop are left unmerged. The pool is then compacted
+   * and the UIDs are made equal to the index of the facets in the pool.
    *
+   * @param pool the pool of facets of the STL file
+   * @param graph the adjacency of the pool
    */
-  void mergeSimilar(LinkedPool &pool, std::vector<ulong> &removed);
+  static void mergeSimilar(LinkedPool &pool, const DualGraph &graph);
 
   // ==========================================================================
   // Sclicing logic
@@ -113,9 +224,28 @@ public:
    * When two childs report the same overlapping (i.e. A overlapping with B and
    * B overlapping with A) the parent should cut the mesh on one of the two
    * edges and displace the splitted part farther.
+   *
+   * @param tasks the task pool detecting the overlaps, if any
    */
   overlaps::MeshOverlaps
-  sliceChildren(const LinkedPool &, std::vector<packing::Box<LinkedPolygon>> &);
+  sliceChildren(LinkedPool &, std::vector<packing::Box<LinkedPolygon>> &,
+                TaskPool *tasks = nullptr);
+
+  /**
+   * @brief Find every overlap of the unfolded tree first, then cut the
+   * smallest set of edges found by TreeMulticut so that no part holds two
+   * overlapping facets. The parts keep the layout of the full unfold.
+   *
+   * @param tasks the task pool detecting the overlaps, if any
+   */
+  void sliceMinCut(LinkedPool &, std::vector<packing::Box<LinkedPolygon>> &,
+                   TaskPool *tasks = nullptr);
+
+  /**
+   * @brief Cut the edge from the parent to this facet, see sliceEdge. The
+   * subtree of this facet becomes a part at the origin.
+   */
+  void sliceFromParent(LinkedPool &pool);
 
   // ==========================================================================
   // STL Model Unfold + SVG Export
@@ -130,8 +260,9 @@ public:
    * @param depth the actual depth
    * @param max_depth the maximum depth
    */
-  void fillSVGString(std::stringstream &stream, const math::HMat &mat,
-                     const std::string &color, int depth, int max_depth);
+  void fillSVGString(LinkedPool &pool, std::stringstream &stream,
+                     const math::RigidTrsf &mat, const std::string &color,
+                     int depth, int max_depth);
 
   /**
    * @brief Fill the given stringstream with the serialized version of this
@@ -141,23 +272,47 @@ public:
    * @param stream the string stream to fill
    * @param mat the transformation matrix to apply
    */
-  void fillSVGProjectString(std::stringstream &stream, const math::HMat &mat,
-                            const math::Vec3 &ax1, const math::Vec3 &ax2,
-                            const std::string &color);
+  void fillSVGProjectString(LinkedPool &pool, std::stringstream &stream,
+                            const math::RigidTrsf &mat, const math::Vec3 &ax1,
+                            const math::Vec3 &ax2, const std::string &color);
+
+  // ==========================================================================
+  // Debug
+  // ==========================================================================
+
+  void displayInformations(std::ostream &os, const LinkedPool &pool) const {
+    auto facets = getEdges(pool);
+    os << "\tMesh " << uid << " : " << std::endl;
+    for (int i = 0; i < facets.size(); i++) {
+      os << "\t  - f" << i + 1 << ((i == facets.size() - 1) ? 1 : i + 2) << " ";
+      facets[i].display(os, getEdgeGeometry(pool, i));
+      os << std::endl;
+    }
+    os << "\t  - Normal [" << n(0) << ", " << n(1) << ", " << n(2) << "]"
+       << std::endl;
+  };
 
 protected:
   // ==========================================================================
   // Facet description
   // ==========================================================================
   // Facet properties
-  ulong uid;                                     //< The UID if this facet
-  std::vector<LinkedEdge<LinkedPolygon>> facets; //< Edges of this facet
-  int parent_edge = INT8_MAX;                    //< Edge to the parent
-  math::Vertex n;                                //< Normal of this facet
+  ulong uid;                  //< The UID if this facet
+  uint32_t first_edge = 0;    //< Index of the first edge in the arena
+  uint32_t n_edges = 0;       //< Number of edges of this facet
+  int parent_edge = INT8_MAX; //< Edge to the parent
+  math::Vertex n;             //< Normal of this facet
 
   // Flattening
-  const math::HMat std_mat; //< Basic HMat for no transforms
-  math::HMat unfold_coef;   //< HMat for transforming n to the world normal
+  math::Rigid2D unfold_coef; //< Placement of the facet frame in the plane
+
+  // Parts
+  uint32_t part = NO_PART;  //< UID of the root of the part of this facet
+  math::RigidTrsf pending;  //< Transform of the part, set on the part root
+
+  // Bounds cache, in the vertex buffer space
+  mutable math::Bounds extent;      //< Extent of the subtree up to the cuts
+  mutable bool extent_dirty = true; //< The extent should be computed again
 
   // ==========================================================================
   // Getters
@@ -166,18 +321,33 @@ protected:
   /**
    * @brief Get the edge corresponding to this number
    */
-  inline LinkedEdge<LinkedPolygon> getEdge(int edge) const {
+  inline const LinkedEdge<LinkedPolygon> &getEdge(const LinkedPool &pool,
+                                                  int edge) const {
+    auto facets = getEdges(pool);
     if (edge < facets.size())
       return facets[edge];
     return facets[0];
   };
 
+  /**
+   * @brief Get the positions of the edge corresponding to this number
+   */
+  inline math::Edge getSafeEdgeGeometry(const LinkedPool &pool,
+                                        int edge) const {
+    return getEdgeGeometry(pool, (edge < n_edges) ? edge : 0);
+  };
+
+  /**
+   * @brief Compute again the outdated extents of the subtree of this facet
+   */
+  void updateExtent(const LinkedPool &pool) const;
+
   /**
    * @brief Get the edge name
    */
   inline std::string getEdgeName(int edge) const {
     std::stringstream ss;
-    ss << "f" << edge + 1 << ((edge == facets.size() - 1) ? 1 : edge + 2);
+    ss << "f" << edge + 1 << ((edge == n_edges - 1) ? 1 : edge + 2);
     return ss.str();
   };
 
@@ -186,9 +356,9 @@ protected:
    *
    * @return a pointer to the parent if exist, else nullptr
    */
-  inline const LinkedPolygon *getParent() const {
-    if (parent_edge < facets.size())
-      return facets[parent_edge].getMesh();
+  inline const LinkedPolygon *getParent(const LinkedPool &pool) const {
+    if (parent_edge < n_edges)
+      return &pool[getEdge(pool, parent_edge).getMesh()];
     return nullptr;
   };
 
@@ -201,8 +371,8 @@ protected:
    *
    * @param name the edge we want the vertices of
    */
-  math::VertexPair getEdgeVertex(int edge) const {
-    return getEdge(edge).pair();
+  math::VertexPair getEdgeVertex(const LinkedPool &pool, int edge) const {
+    return getSafeEdgeGeometry(pool, edge).pair();
   };
 
   /**
@@ -218,13 +388,14 @@ protected:
    * @param edge the edge we will make the vector for
    * @return an homogenous eigen vector representing the edge direction
    */
-  math::Vertex getEdgeDirection(int edge, bool normalized = false) const {
-    if (edge < facets.size())
-      return getEdge(edge).dir(normalized);
-    if (math::Edge::colinear(n, getParentNormal())) {
+  math::Vertex getEdgeDirection(const LinkedPool &pool, int edge,
+                                bool normalized = false) const {
+    if (edge < n_edges)
+      return getSafeEdgeGeometry(pool, edge).dir(normalized);
+    if (math::Edge::colinear(n, getParentNormal(pool))) {
       return math::Vertex{1, 0, 0};
     } else {
-      math::Vertex pn = getParentNormal();
+      math::Vertex pn = getParentNormal(pool);
       math::Vec3 dir =
           math::Vec3{n(0), n(1), n(2)}.cross(math::Vec3{pn(0), pn(1), pn(2)});
       return math::Vertex{dir(0), dir(1), dir(2), 0};
@@ -237,7 +408,9 @@ protected:
    * @param edge the edge we will make the vector for
    * @return Vec3 a eigen vector representing the edge position
    */
-  math::Vertex getEdgePosition(int edge) const { return getEdge(edge).pos(); };
+  math::Vertex getEdgePosition(const LinkedPool &pool, int edge) const {
+    return getSafeEdgeGeometry(pool, edge).pos();
+  };
 
   /**
    * @brief Get the Normal vector of the parent of this facet. If there is no
@@ -245,60 +418,50 @@ protected:
    *
    * @return an homogenous eigen vector
    */
-  math::Vertex getParentNormal() const {
-    if (getParent() != nullptr)
-      return getParent()->getNormal();
+  math::Vertex getParentNormal(const LinkedPool &pool) const {
+    if (getParent(pool) != nullptr)
+      return getParent(pool)->getNormal();
     return math::Vertex{0, 0, 1, 0};
   }
 
-  /**
-   * @brief Get the parent transformation matrix (transforming the parent to the
-   * X-Y world plane)
-   *
-   * @return const math::HMat
-   */
-  const math::HMat getParentTrsf() const {
-    if (getParent() != nullptr)
-      return getParent()->unfold_coef;
-    return std_mat;
-  }
-
   // ==========================================================================
   // Transformations
   // ==========================================================================
 
   /**
-   * @brief Get the rotation matrix for a transformation between the two
-   * normals of this facets and its parent.
+   * @brief Get the placement in the world plane of the frame of this facet,
+   * whose origin is the first vertex of the parent edge and whose X axis
+   * follows this edge. The parent should already be unfolded, its copy of the
+   * shared edge giving the placement.
    *
-   * @return HMat a 4x4 homogenous eigen matrix representing this rotation
+   * The root has no parent edge: it is rotated around an horizontal axis, as
+   * given by getEdgeDirection, and keeps its position in the X-Y plane.
    */
-  math::HMat getHRotationMatrix() const;
+  math::Rigid2D getPlacement(const LinkedPool &pool) const;
 
   /**
-   * @brief Compute the transformation matrix between the world and the given
-   * edge on this facet.
-   *
-   * @return HMat a 4x4 homogenous eigen matrix representing this rotation.
+   * @brief Put this face into the world plane: its vertices are expressed in
+   * the frame of the facet (X along the parent edge, Y = n x X) then placed
+   * by getPlacement. The parent should already be unfolded.
    */
-  math::HMat getHTransform(int edge) const;
+  void unfoldFacet(LinkedPool &pool);
 
   // ==========================================================================
   // Linking logic
   // ==========================================================================
 
   /**
-   * @brief Test whether the caller has two common points with this facet.
-   * If two points are found, then they are neighbours on the given edge.
-   * This function link the called facet to the caller facet in the case they
-   * are neighbours.
+   * @brief Link the called facet to the caller facet, which is its neighbour
+   * through the given edges. The caller becomes the parent if this facet has
+   * none yet.
    *
-   * @param parent_facet the caller facet
-   * @param edge the edge that they should share
-   * @return true if the two facets are neighbours
-   * @return false if they are not neighbours
+   * @param pool the pool of facets of the STL file
+   * @param parent_facet the index of the caller facet
+   * @param edge the shared edge on the caller
+   * @param on_edge the shared edge on this facet
    */
-  bool hasSameEdge(LinkedPolygon *parent_facet, int edge, int &on_edge);
+  void linkToNeighbour(LinkedPool &pool, uint32_t parent_facet, int edge,
+                       int on_edge);
 
   // ==========================================================================
   // Sclicing logic
@@ -311,37 +474,28 @@ protected:
    *
    * @param edge the edge which will be translated
    */
-  void sliceEdge(int edge);
+  void sliceEdge(LinkedPool &pool, int edge);
 
   /**
    * @brief Slice the mesh from the parent edge
    *
    * @param cut_number the cut UID
    */
-  void cutOnParentEdge(int cut_number);
+  void cutOnParentEdge(LinkedPool &pool, int cut_number);
 
   /**
-   * @brief Return the overlaps between this facets and the others
+   * @brief Cut the edges of this facet whose child shares an overlap with
+   * another child or with this facet.
+   *
+   * @param overlaps the overlaps reported by the children, one per edge, the
+   * last element being filled with the overlaps of this facet. The overlaps
+   * not processed by this facet are gathered in the first element.
+   * @param graph the overlaps of the pool
    */
-  overlaps::MeshOverlaps hasOverlaps(const LinkedPool &pool);
-
-  // ==========================================================================
-  // Debug
-  // ==========================================================================
-  void displayInformations(std::ostream &os) const {
-    os << "\tMesh " << uid << " : " << std::endl;
-    for (int i = 0; i < facets.size(); i++) {
-      os << "\t  - f" << i + 1 << ((i == facets.size() - 1) ? 1 : i + 2) << " "
-         << facets[i] << std::endl;
-    }
-  };
-
-  friend std::ostream &operator<<(std::ostream &os, const LinkedPolygon &mesh) {
-    mesh.displayInformations(os);
-    os << "\t  - Normal [" << mesh.n(0) << ", " << mesh.n(1) << ", "
-       << mesh.n(2) << "]" << std::endl;
-    return os;
-  }
+  void sliceFacet(LinkedPool &pool,
+                  std::vector<packing::Box<LinkedPolygon>> &boxes,
+                  std::vector<overlaps::MeshOverlaps> &overlaps,
+                  OverlapGraph &graph);
 };
 
 } // namespace kami
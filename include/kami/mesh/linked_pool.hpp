@@ -4,6 +4,7 @@
 #include "kami/export/paper_format.hpp"
 #include "kami/global/arguments.hpp"
 #include "kami/global/logging.hpp"
+#include "kami/io/stl_reader.hpp"
 #include "kami/mesh/linked_poly.hpp"
 #include "kami/packing/bin.hpp"
 #include "kami/packing/box.hpp"
@@ -22,14 +23,13 @@ typedef std::vector<MeshBox> MeshBoxVector;
 // ==========================================================================
 
 /**
- * @brief Represent a pool of facet that are possibly not linked together
+ * @brief Represent a pool of facet that are possibly not linked together. The
+ * facets and their edges are stored in the arena, and the UID of a facet is
+ * its index in the pool.
  *
  */
-struct LinkedMeshPool : std::vector<std::shared_ptr<LinkedPolygon>> {
-  LinkedMeshPool(unsigned long _size)
-      : std::vector<std::shared_ptr<LinkedPolygon>>(
-            std::vector<std::shared_ptr<LinkedPolygon>>(_size)) {}
-  LinkedMeshPool(microstl::Mesh &mesh);
+struct LinkedMeshPool : PolygonArena<LinkedPolygon> {
+  LinkedMeshPool(const io::StlMesh &mesh);
 
   // ==========================================================================
   // Linking
@@ -54,11 +54,18 @@ struct LinkedMeshPool : std::vector<std::shared_ptr<LinkedPolygon>> {
    * the linked mesh)
    *
    * @param max_depth the maximum of recursivity (-1 for no limit)
+   * @param n_threads the number of threads unfolding the subtrees
    */
-  void unfold(ulong max_depth) {
+  void unfold(ulong max_depth, int n_threads = 1) {
     TIMED_UTILS;
-    TIMED_SECTION("Unfolding the linked mesh",
-                  (*this)[root]->unfoldMesh(0, max_depth));
+    TIMED_SECTION("Unfolding the linked mesh", {
+      if (n_threads > 1) {
+        TaskPool tasks(n_threads);
+        (*this)[root].unfoldMesh(*this, 0, max_depth, &tasks);
+      } else {
+        (*this)[root].unfoldMesh(*this, 0, max_depth);
+      }
+    });
   }
 
   /**
@@ -69,11 +76,8 @@ struct LinkedMeshPool : std::vector<std::shared_ptr<LinkedPolygon>> {
   void scaleFigure(double scaling_factor) {
     TIMED_UTILS;
     TIMED_SECTION("Rescaling the mesh", {
-      math::HMat mat;
-      mat(0, 0) = scaling_factor;
-      mat(1, 1) = scaling_factor;
-      mat(2, 2) = scaling_factor;
-      (*this)[root]->transform(mat, true, false);
+      (*this)[root].transform(
+          *this, math::RigidTrsf::scaling(scaling_factor), true, false);
     });
   }
 
@@ -91,8 +95,30 @@ struct LinkedMeshPool : std::vector<std::shared_ptr<LinkedPolygon>> {
   /**
    * @brief Slice the children into part to prevent mesh overlapping or parts
    * being too big for the bin to contains.
+   *
+   * @param n_threads the number of threads detecting the overlaps
+   * @param mode how to choose the edges to cut
+   * @param engine how to put the parts on the sheets
+   */
+  MeshBinVector
+  slice(int n_threads = 1, args::SlicingMode mode = args::SlicingMode::GREEDY,
+        args::PackingEngine engine = args::PackingEngine::TP_RF);
+
+  /**
+   * @brief Test whether the box fits in the bin format, as is or rotated by
+   * 90 degrees
+   */
+  bool fitsFormat(const MeshBox &box) const {
+    return (box.width <= format.width && box.height <= format.height) ||
+           (box.height <= format.width && box.width <= format.height);
+  }
+
+  /**
+   * @brief Cut the parts which do not fit in the bin format, on the tree edge
+   * splitting their facets in the most balanced way, until every part fits or
+   * is a single facet. The pieces are moved back to the origin.
    */
-  MeshBinVector slice();
+  void splitOversized(MeshBoxVector &boxes);
 
   // ==========================================================================
   // Exporting
@@ -110,10 +136,18 @@ struct LinkedMeshPool : std::vector<std::shared_ptr<LinkedPolygon>> {
    */
   MeshBinVector binPackingAlgorithm(MeshBoxVector &);
 
+  /**
+   * @brief Organise the boxes into several bins of the wanted size with the
+   * MaxRects algorithm: each box, by decreasing area, goes in the free
+   * rectangle of the open bins leaving the shortest side free (BSSF), as is or
+   * rotated. A new bin is opened only when it fits nowhere.
+   */
+  MeshBinVector maxRectsAlgorithm(MeshBoxVector &);
+
   /**
    * @brief Transform the given bin into a SVG String
    */
-  std::string getAsSVGString(MeshBin &, const args::Args &args) const;
+  std::string getAsSVGString(MeshBin &, const args::Args &args);
 
   /**
    * @brief Create the color map for all facets
@@ -206,8 +240,8 @@ struct LinkedMeshPool : std::vector<std::shared_ptr<LinkedPolygon>> {
                                   const LinkedMeshPool &pool) {
     printStepHeader("Pool faces");
     os << "    Number of faces : " << pool.size() << std::endl;
-    for (const std::shared_ptr<LinkedPolygon> mesh : pool) {
-      os << *mesh;
+    for (const LinkedPolygon &mesh : pool.polygons) {
+      mesh.displayInformations(os, pool);
     }
     return os;
   }
@@ -220,7 +254,7 @@ private:
   std::map<ulong, std::string> color_map;
 
   // Unfold unlinked backup for projection
-  std::vector<LinkedPolygon> _unfold_unlinked;
+  PolygonArena<LinkedPolygon> _unfold_unlinked;
   bool _unfold_transformed = false;
   math::Bounds _unfolded_bounds;
 };
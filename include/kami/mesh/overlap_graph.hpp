@@ -0,0 +1,74 @@
+#ifndef KAMI_MESH_OVERLAP_GRAPH
+#define KAMI_MESH_OVERLAP_GRAPH
+
+#include "kami/global/task_pool.hpp"
+#include "kami/math/overlaps.hpp"
+#include "kami/mesh/polygon_arena.hpp"
+#include "kami/mesh/tree_bvh.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+class LinkedPolygon;
+
+// ==========================================================================
+// Overlap graph
+// ==========================================================================
+
+/**
+ * @brief Overlapping facets of a pool during the slicing, kept up to date as
+ * the cut parts move.
+ *
+ * The slicing reads the overlaps of each facet once, then only moves parts of
+ * facets already read. A pair of unread facets thus never changes, and a moved
+ * part only has to be tested again against the unread facets. The pairs
+ * between two read facets are not kept.
+ */
+class OverlapGraph {
+public:
+  static constexpr uint32_t DETECT_GRAIN{256}; //< Faces of a detection task
+
+  /**
+   * @brief Find every overlapping pair of the pool, each pair being tested
+   * once. The candidates of each facet come from an OverlapGrid of the facet
+   * boxes.
+   *
+   * With a task pool, the faces are tested by ranges of DETECT_GRAIN faces in
+   * parallel. Each range fills its own buffer, and the buffers are merged in
+   * the order of the ranges, so that the graph is the one of the serial run.
+   *
+   * @param pool the pool of facets
+   * @param root the root of the unfold tree
+   * @param tasks the task pool, if any
+   */
+  OverlapGraph(const PolygonArena<LinkedPolygon> &pool, uint32_t root,
+               TaskPool *tasks = nullptr);
+
+  /**
+   * @brief Add the overlaps of the given facet to the set, and mark it read
+   */
+  void read(uint32_t face, overlaps::MeshOverlaps &out);
+
+  /**
+   * @brief Test again the facets of the given part, which moved, against the
+   * unread facets
+   */
+  void update(const PolygonArena<LinkedPolygon> &pool, uint32_t part_root);
+
+private:
+  void link(uint32_t face1, uint32_t face2);
+
+  /**
+   * @brief Remove all the pairs of the given facet
+   */
+  void unlinkAll(uint32_t face);
+
+  TreeBVH bvh;                                 //< Boxes of the unread facets
+  std::vector<std::vector<uint32_t>> overlaps; //< Overlapping facets
+  std::vector<bool> was_read;                  //< Overlaps already read
+};
+
+} // namespace kami
+
+#endif
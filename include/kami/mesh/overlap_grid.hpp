@@ -0,0 +1,62 @@
+#ifndef KAMI_MESH_OVERLAP_GRID
+#define KAMI_MESH_OVERLAP_GRID
+
+#include "kami/mesh/tree_bvh.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+// ==========================================================================
+// Overlap grid
+// ==========================================================================
+
+/**
+ * @brief Uniform grid over the unfolded plane, each cell listing the facets
+ * whose 2D box touches it.
+ *
+ * Two facets can only overlap where their boxes meet, hence in a cell they
+ * share. The boxes are the ones of the facets when the grid is built: the grid
+ * serves the first detection, before any part moves. The cells are sized from
+ * the bounds of the boxes, about one cell per facet.
+ */
+class OverlapGrid {
+public:
+  static constexpr uint32_t MAX_CELLS_PER_AXIS{4096};
+
+  /**
+   * @brief Bin the facet boxes of the hierarchy
+   *
+   * @param bvh the boxes of the facets
+   * @param n_faces the number of facets of the pool
+   */
+  OverlapGrid(const TreeBVH &bvh, uint32_t n_faces);
+
+  /**
+   * @brief Get the facets of higher UID than the given one whose box meets its
+   * box, in increasing order
+   */
+  void getCandidates(uint32_t face, std::vector<uint32_t> &candidates) const;
+
+private:
+  /**
+   * @brief Range of cells [x0, x1] x [y0, y1] touched by a box
+   */
+  struct CellRect {
+    uint32_t x0, y0, x1, y1;
+  };
+
+  CellRect getCells(const TreeBVH::Box &box) const;
+
+  const TreeBVH &bvh;
+  double x0 = 0, y0 = 0;   //< Corner of the first cell
+  double cell_size = 1;    //< Side of a cell
+  uint32_t nx = 1, ny = 1; //< Number of cells on each axis
+
+  std::vector<std::vector<uint32_t>> cells; //< Facets of each cell
+  std::vector<CellRect> rects;              //< Cells of each facet
+};
+
+} // namespace kami
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef KAMI_MESH_POLYGON_ARENA
+#define KAMI_MESH_POLYGON_ARENA
+
+#include "kami/math/edge.hpp"
+#include "kami/math/vertex_buffer.hpp"
+#include "kami/mesh/linked_edge.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+// ==========================================================================
+// Edge range
+// ==========================================================================
+
+/**
+ * @brief View on the contiguous edges of one polygon inside the arena
+ *
+ * @tparam E the edge type (possibly const)
+ */
+template <typename E> struct EdgeRange {
+  E *first;
+  size_t n;
+
+  size_t size() const { return n; }
+  E &operator[](size_t i) const { return first[i]; }
+  E *begin() const { return first; }
+  E *end() const { return first + n; }
+};
+
+// ==========================================================================
+// Polygon arena
+// ==========================================================================
+
+/**
+ * @brief Storage of a mesh: the polygons and their edges live in two
+ * contiguous arrays. A polygon refers to its edges by a range of indices, and
+ * the edges refer to the neighbour polygons by their index in the arena, which
+ * is also their UID.
+ *
+ * The positions are kept in a vertex buffer with one point per polygon corner:
+ * the point i is the first vertex of the edge i, and the second vertex of an
+ * edge is the first vertex of the next edge of the same polygon.
+ *
+ * @tparam T the polygon type
+ */
+template <typename T> struct PolygonArena {
+  std::vector<T> polygons;          //< Polygons, indexed by UID
+  std::vector<LinkedEdge<T>> edges; //< Edges of all the polygons
+  math::VertexBuffer vertices;      //< First vertex of each edge
+
+  size_t size() const { return polygons.size(); }
+
+  T &operator[](size_t i) { return polygons[i]; }
+  const T &operator[](size_t i) const { return polygons[i]; }
+
+  EdgeRange<LinkedEdge<T>> getEdges(uint32_t first, uint32_t n) {
+    return EdgeRange<LinkedEdge<T>>{edges.data() + first, n};
+  }
+  EdgeRange<const LinkedEdge<T>> getEdges(uint32_t first, uint32_t n) const {
+    return EdgeRange<const LinkedEdge<T>>{edges.data() + first, n};
+  }
+};
+
+} // namespace kami
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef KAMI_MESH_TREE_BVH
+#define KAMI_MESH_TREE_BVH
+
+#include "kami/mesh/polygon_arena.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+class LinkedPolygon;
+
+// ==========================================================================
+// Unfold tree bounding volumes
+// ==========================================================================
+
+/**
+ * @brief Bounding-volume hierarchy made of the unfold tree: every facet holds
+ * the 2D box of its own edges and the box of its whole subtree, through the
+ * cut edges.
+ *
+ * Two edges can only cross inside both of their boxes, so a subtree whose box
+ * misses the box of a facet has no facet overlapping with it. The facets of
+ * the pool out of the tree are kept as single-facet roots. The boxes are the
+ * ones of the facets when the hierarchy is built.
+ */
+class TreeBVH {
+public:
+  /**
+   * @brief Axis-aligned 2D box
+   */
+  struct Box {
+    double xmin, xmax, ymin, ymax;
+
+    inline bool meets(const Box &other) const {
+      return xmin <= other.xmax && other.xmin <= xmax && ymin <= other.ymax &&
+             other.ymin <= ymax;
+    }
+
+    inline Box &operator+=(const Box &other) {
+      xmin = (other.xmin < xmin) ? other.xmin : xmin;
+      xmax = (other.xmax > xmax) ? other.xmax : xmax;
+      ymin = (other.ymin < ymin) ? other.ymin : ymin;
+      ymax = (other.ymax > ymax) ? other.ymax : ymax;
+      return *this;
+    }
+  };
+
+  /**
+   * @brief Build the boxes of the tree rooted on the given facet, children
+   * before their parents
+   */
+  TreeBVH(const PolygonArena<LinkedPolygon> &pool, uint32_t root);
+
+  const Box &getFaceBox(uint32_t face) const { return face_boxes[face]; }
+  const Box &getSubtreeBox(uint32_t face) const { return subtree_boxes[face]; }
+
+  /**
+   * @brief Get the facets, other than the given one, whose box meets the given
+   * box, in increasing order. The subtrees whose box misses it are skipped.
+   *
+   * @param pool the pool of facets
+   * @param box the box to test
+   * @param face the facet to leave out
+   * @param candidates the vector to fill
+   * @param skipped if given, the subtrees whose root is flagged are skipped too
+   */
+  void getCandidates(const PolygonArena<LinkedPolygon> &pool, const Box &box,
+                     uint32_t face, std::vector<uint32_t> &candidates,
+                     const std::vector<bool> *skipped = nullptr) const;
+
+  /**
+   * @brief Compute the box of the edges of the given facet, at its actual
+   * position
+   */
+  static Box computeFaceBox(const PolygonArena<LinkedPolygon> &pool,
+                            uint32_t face);
+
+private:
+  /**
+   * @brief Make the subtree box of the facet from its own box and the subtree
+   * boxes of its children
+   */
+  void mergeChildren(const PolygonArena<LinkedPolygon> &pool, uint32_t face);
+
+  std::vector<uint32_t> roots;    //< Roots of the hierarchy
+  std::vector<Box> face_boxes;    //< Box of the edges of each facet
+  std::vector<Box> subtree_boxes; //< Box of the subtree of each facet
+};
+
+} // namespace kami
+
+#endif
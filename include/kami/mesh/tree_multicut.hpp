@@ -0,0 +1,155 @@
+#ifndef KAMI_MESH_TREE_MULTICUT
+#define KAMI_MESH_TREE_MULTICUT
+
+#include "kami/math/overlaps.hpp"
+#include "kami/mesh/polygon_arena.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+class LinkedPolygon;
+
+// ==========================================================================
+// Tree multicut
+// ==========================================================================
+
+/**
+ * @brief Smallest set of edges of the unfold tree to cut so that no part holds
+ * two overlapping facets.
+ *
+ * The facets of a part keep their relative positions, so two overlapping
+ * facets are apart once an edge on the tree path between them is cut: the cut
+ * edges must hit every such path. Each tree edge is named by the child facet
+ * below it.
+ *
+ * The pairs are first taken by decreasing depth of their common ancestor.
+ * Once the deeper pairs are solved, the edge just below the ancestor on each
+ * side of a path hits all the paths the lower edges of this side would, so
+ * the pairs of an ancestor only choose among the edges to its children: a
+ * vertex cover of its children, solved exactly for a few children. The groups
+ * of pairs whose paths share no edge are then independent: each one keeps
+ * this cover or the one cutting first the edges on the most paths, whichever
+ * is the smallest once the useless cuts are removed, and the small ones are
+ * solved again exactly by branch and bound. The paths of a mesh mostly share
+ * edges, leaving a single big group: the cover is then improved by windows of
+ * a few nearby cuts, the pairs only these cuts separate being few enough for
+ * the branch and bound to look for fewer edges separating them.
+ */
+class TreeMulticut {
+public:
+  static constexpr uint32_t NO_NODE{UINT32_MAX};
+  static constexpr size_t EXACT_CHILDREN{16}; //< Max children of exact covers
+  static constexpr size_t EXACT_PAIRS{64};    //< Max pairs of exact groups
+  static constexpr size_t EXACT_BUDGET{1 << 16}; //< Branches of exact groups
+  static constexpr size_t WINDOW_CUTS{8};        //< Max cuts of a window
+  static constexpr size_t WINDOW_BUDGET{1 << 12}; //< Branches of a window
+
+  /**
+   * @brief Choose the edges to cut in the tree rooted on the given facet. The
+   * pairs with a facet out of the tree are ignored.
+   *
+   * @param pool the pool of facets
+   * @param root the root of the unfold tree
+   * @param pairs the overlapping facets
+   */
+  TreeMulticut(const PolygonArena<LinkedPolygon> &pool, uint32_t root,
+               const overlaps::MeshOverlaps &pairs);
+
+  /**
+   * @brief Test whether the edge from the given facet to its parent is cut
+   */
+  bool isCut(uint32_t face) const { return cut[face]; }
+
+  size_t getCutCount() const { return n_cuts; }
+  size_t getGroupCount() const { return n_groups; }
+  size_t getExactGroupCount() const { return n_exact; }
+  size_t getExactWindowCount() const { return n_windows; }
+  size_t getSavedCutCount() const { return n_saved; }
+
+private:
+  /**
+   * @brief A pair of overlapping facets, its path going up from the first
+   * facet to their common ancestor on path[start, middle), and from the second
+   * one on path[middle, end).
+   */
+  struct Demand {
+    uint32_t ancestor;
+    size_t start, middle, end;
+
+    uint32_t getSide(const std::vector<uint32_t> &path, bool second) const {
+      size_t first = second ? middle : start, last = second ? end : middle;
+      return (last > first) ? path[last - 1] : NO_NODE;
+    }
+  };
+
+  void addDemand(uint32_t face1, uint32_t face2);
+  bool isSeparated(const Demand &demand) const;
+
+  /**
+   * @brief Cut the edges to the children of an ancestor so that its pairs are
+   * all separated
+   */
+  void coverChildren(const std::vector<size_t> &group);
+
+  /**
+   * @brief Cut first the edges on the most paths not separated yet
+   */
+  std::vector<bool> coverWidest() const;
+
+  /**
+   * @brief Uncut the edges whose pairs are all separated by other cuts, the
+   * edges on the fewest paths first
+   */
+  void removeRedundant(std::vector<bool> &cuts) const;
+
+  /**
+   * @brief Keep the best cover of each independent group of pairs, and solve
+   * again exactly the groups of few pairs
+   */
+  void improveGroups();
+
+  /**
+   * @brief Get the pairs of the group whose path holds the path of no other
+   * pair of the group: an edge separating them separates the whole group. The
+   * search stops once more than limit pairs are found.
+   */
+  std::vector<size_t> getMinimalPairs(const std::vector<size_t> &group,
+                                      size_t limit);
+
+  /**
+   * @brief Look by branch and bound, within the budget, for fewer than bound
+   * edges separating all the pairs of a group of at most EXACT_PAIRS pairs
+   *
+   * @param group the pairs to separate
+   * @param bound the size of the cover to beat
+   * @param budget the number of branches allowed
+   * @param cover the edges found, empty if no smaller cover was found
+   * @return true if the search went through all the branches
+   */
+  bool coverExactly(const std::vector<size_t> &group, size_t bound,
+                    size_t budget, std::vector<uint32_t> &cover);
+
+  /**
+   * @brief For each cut, take the window of at most WINDOW_CUTS cuts on the
+   * paths it separates, and replace them by fewer edges when the exact search
+   * finds some for the pairs only these cuts separate. Repeated until no
+   * window improves.
+   */
+  void improveWindows();
+
+  std::vector<uint32_t> parent; //< Parent of each facet of the tree
+  std::vector<uint32_t> depth;  //< Depth of each facet of the tree
+  std::vector<uint32_t> uses;   //< Paths through the edge of each facet
+  std::vector<bool> cut;        //< Cut edge above each facet
+  std::vector<uint64_t> edge_masks; //< Pairs of the searched group per edge
+
+  std::vector<Demand> demands;
+  std::vector<uint32_t> path; //< Edges of the paths of the demands
+
+  size_t n_cuts = 0, n_groups = 0, n_exact = 0, n_windows = 0, n_saved = 0;
+};
+
+} // namespace kami
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef KAMI_MESH_WELDING
+#define KAMI_MESH_WELDING
+
+#include "kami/io/stl_reader.hpp"
+#include "kami/math/base_types.hpp"
+#include "kami/math/vertex.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace kami {
+
+// ==========================================================================
+// Welded mesh
+// ==========================================================================
+
+/**
+ * @brief Indexed version of an STL mesh: every facet corner refers to a unique
+ * vertex through a stable integer id.
+ */
+struct WeldedMesh {
+  std::vector<math::Vertex> vertices;  //< Unique vertices
+  std::vector<math::VertexId> corners; //< Vertex ids, 3 per facet
+  std::vector<math::Vertex> normals;   //< Normal of each facet
+
+  size_t size() const { return normals.size(); }
+
+  const math::VertexId *getFacetCorners(size_t facet) const {
+    return &corners[3 * facet];
+  }
+};
+
+/**
+ * @brief Merge the vertices of the mesh that are closer than the tolerance.
+ *
+ * The positions are quantized into a hash grid of cells twice as big as the
+ * tolerance, so that a vertex only has to be compared with the vertices of the
+ * 8 cells it is the closest to. Ids are given in the order the corners appear
+ * in the file, which makes them stable across runs.
+ *
+ * @param mesh the STL mesh
+ * @param tolerance the distance under which two vertices are the same
+ */
+WeldedMesh weldVertices(const io::StlMesh &mesh,
+                        double tolerance = math::MAX_DISTANCE);
+
+} // namespace kami
+
+#endif
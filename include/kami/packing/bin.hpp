@@ -4,9 +4,11 @@
 #include "kami/export/paper_format.hpp"
 #include "kami/math/edge.hpp"
 #include "kami/packing/box.hpp"
+#include "kami/packing/box_index.hpp"
 #include "kami/packing/corner.hpp"
 #include <algorithm>
 #include <ostream>
+#include <set>
 #include <sstream>
 #include <vector>
 
@@ -21,27 +23,25 @@ template <typename T> struct Bin {
     return make_id++;
   }
 
-  Bin(const out::PaperFormat &format) : format(format) {
+  Bin(const out::PaperFormat &format) : format(format), index(format) {
     id = getId();
-    corners.resize(0);
-    corners.push_back(Corner());
+    corners.insert(Corner());
   }
-  Bin() : format(out::PaperA<4>()) {
+  Bin() : format(out::PaperA<4>()), index(format) {
     id = getId();
-    corners.resize(0);
-    corners.push_back(Corner());
+    corners.insert(Corner());
   }
 
   int id = -1;
   out::PaperFormat format;
   std::vector<Box<T>> boxes;
-  std::vector<Corner> corners;
+  std::set<Corner, Corner::Less> corners;
 
-  double getScore(const ulong corner, const Box<T> &box, bool rotated) {
+  double getScore(const Corner &corner, const Box<T> &box, bool rotated) {
     Box<T> tempbox = Box<T>(box);
     tempbox.rotated = rotated;
-    tempbox.x = corners[corner].x;
-    tempbox.y = corners[corner].y;
+    tempbox.x = corner.x;
+    tempbox.y = corner.y;
 
     double cumulated = 0;
     if ((tempbox.x + tempbox.getWidth() > format.width) ||
@@ -58,120 +58,46 @@ template <typename T> struct Bin {
     if (std::fabs(tempbox.y + tempbox.getHeight() - format.height) <= STHRES)
       cumulated += tempbox.getWidth();
 
-    // Check for other boxes
-    for (auto &other : boxes) {
-      // Checking box collisions
-      if (tempbox.isColiding(other))
-        return -1;
-
-      for (int temp_edge = 0; temp_edge < 4; temp_edge++) {
-        for (int other_edge = 0; other_edge < 4; other_edge++) {
-          // Check collision
-          cumulated += math::Edge::overlapsLength(tempbox.getEdge(temp_edge),
-                                                  other.getEdge(other_edge));
-        }
-      }
-    }
+    // Check for the boxes around
+    bool free = index.forEachNear(
+        tempbox.x, tempbox.y, tempbox.getWidth(), tempbox.getHeight(),
+        [&](ulong i) {
+          if (tempbox.overlaps(boxes[i]))
+            return false;
+          cumulated += tempbox.getContactLength(boxes[i]);
+          return true;
+        });
+    if (!free)
+      return -1;
     return cumulated / (2 * tempbox.width + 2 * tempbox.height) * 100;
   }
 
-  void putIn(const ulong corner, Box<T> &box, bool rotated) {
+  void putIn(const Corner &corner, Box<T> &box, bool rotated) {
     // Change box
-    box.x = (corners[corner].x < STHRES) ? 0 : corners[corner].x;
-    box.y = (corners[corner].y < STHRES) ? 0 : corners[corner].y;
+    box.x = (corner.x < STHRES) ? 0 : corner.x;
+    box.y = (corner.y < STHRES) ? 0 : corner.y;
     box.rotated = rotated;
     boxes.push_back(box);
-
-    // Recompute all corners
-    corners.resize(0);
-    for (Box<T> &valid_box : boxes) {
-      // Make corner 1 (bottom-right) and corner 2 (top-left
-      auto c1 = Corner(valid_box.x + valid_box.getWidth(), valid_box.y, C1);
-      auto c2 = Corner(valid_box.x, valid_box.y + valid_box.getHeight(), C2);
-
-      // And their projections
-      auto cx = Corner(c2, CX);
-      auto cy = Corner(c1, CY);
-
-      double saved_x = 0, saved_y = 0;
-      for (Box<T> &other : boxes) {
-        if (valid_box.id == other.id)
-          continue;
-
-        // For Cx
-        if ((other.y < cx.y) && (cx.y < other.y + other.getHeight())) {
-          saved_x = ((other.x + other.getWidth() > saved_x) &&
-                     (other.x + other.getWidth() <= cx.x))
-                        ? other.x + other.getWidth()
-                        : saved_x;
-        }
-
-        // For Cy
-        if ((other.x < cy.x) && (cy.x < other.x + other.getWidth())) {
-          saved_y = ((other.y + other.getHeight() > saved_y) &&
-                     (other.y + other.getHeight() <= cy.y))
-                        ? other.y + other.getHeight()
-                        : saved_y;
-        }
-      }
-      cx.x = saved_x;
-      cy.y = saved_y;
-
-      bool use_cx = !(cx.x == c2.x);
-      bool use_cy = !(cy.y == c1.y);
-
-      // Project corners
-      bool c1_on_another = false, c1_taken = false;
-      bool c2_in_corner = false, c2_taken = false;
-      bool cx_taken = false, cy_taken = false;
-
-      // Test if corners are valid
-      c1_on_another = (c1.y == 0);
-      c2_in_corner = (c2.x == 0);
-      for (Box<T> &other : boxes) {
-        if (valid_box.id == other.id)
-          continue;
-
-        // For C1
-        c1_on_another =
-            c1_on_another ||
-            ((c1.x > other.x) && (c1.x < other.x + other.getWidth()) &&
-             (std::fabs(c1.y - other.y - other.getHeight()) < STHRES));
-        c1_taken = c1_taken || (std::fabs(c1.x - other.x) < STHRES &&
-                                std::fabs(c1.y - other.y) < STHRES);
-
-        // For C2
-        c2_in_corner =
-            c2_in_corner ||
-            ((std::fabs(c2.x - other.x - other.getWidth()) < STHRES) &&
-             (c2.y > other.y) && (c2.y < other.y + other.getHeight()));
-        c2_taken = c2_taken || (std::fabs(c2.x - other.x) < STHRES &&
-                                std::fabs(c2.y - other.y) < STHRES);
-
-        cx_taken = cx_taken || (std::fabs(cx.x - other.x) < STHRES &&
-                                std::fabs(cx.y - other.y) < STHRES);
-        cy_taken = cy_taken || (std::fabs(cy.x - other.x) < STHRES &&
-                                std::fabs(cy.y - other.y) < STHRES);
-      }
-
-      // If they are, add them
-      if (c1_on_another && !c1_taken)
-        corners.push_back(c1);
-      if (c2_in_corner && !c2_taken)
-        corners.push_back(c2);
-      if (use_cx && !cx_taken)
-        corners.push_back(cx);
-      if (use_cy && !cy_taken)
-        corners.push_back(cy);
+    box_corners.emplace_back();
+    index.insert(box.x, box.y, box.getWidth(), box.getHeight());
+
+    // The corners of the empty bin
+    if (boxes.size() == 1)
+      corners.clear();
+
+    // Only the corners of the boxes the new one is seen from can change
+    const Box<T> &added = boxes.back();
+    for (ulong i = 0; i + 1 < boxes.size(); i++) {
+      if (isSeenFrom(boxes[i], added))
+        makeCorners(i);
     }
-
-    std::sort(corners.begin(), corners.end(), Corner::compare);
+    makeCorners(boxes.size() - 1);
   }
 
   std::string printCornerVector() {
     std::stringstream ss;
     ulong index = 0;
-    for (Corner &c : corners)
+    for (const Corner &c : corners)
       ss << "\t" << index++ << " -> " << c << std::endl;
     return ss.str();
   }
@@ -180,6 +106,128 @@ template <typename T> struct Bin {
     os << "Bin " << bin.id << " " << bin.format;
     return os;
   }
+
+private:
+  std::vector<std::vector<Corner>> box_corners; //< Corners made by each box
+  BoxIndex index;                               //< Cells of the boxes
+
+  /**
+   * @brief Test whether the corners of the valid box depend on the other box:
+   * its projections cross it, or one of its corners lies on its bottom-left
+   * corner or on its right and top sides
+   */
+  static bool isSeenFrom(const Box<T> &valid_box, const Box<T> &other) {
+    double c1_x = valid_box.x + valid_box.getWidth();
+    double c2_y = valid_box.y + valid_box.getHeight();
+
+    // Projection of C2 to the left, and C2 on the right side
+    if ((other.y < c2_y) && (c2_y < other.y + other.getHeight()) &&
+        (other.x + other.getWidth() <= valid_box.x + STHRES))
+      return true;
+
+    // Projection of C1 to the bottom, and C1 on the top side
+    if ((other.x < c1_x) && (c1_x < other.x + other.getWidth()) &&
+        (other.y + other.getHeight() <= valid_box.y + STHRES))
+      return true;
+
+    // Corners (or their projections) taken by the box
+    return ((std::fabs(other.y - c2_y) < STHRES) &&
+            (other.x < valid_box.x + STHRES)) ||
+           ((std::fabs(other.x - c1_x) < STHRES) &&
+            (other.y < valid_box.y + STHRES));
+  }
+
+  /**
+   * @brief Replace the corners made by the box of the given index
+   */
+  void makeCorners(const ulong index) {
+    for (const Corner &c : box_corners[index])
+      corners.erase(c);
+    box_corners[index].clear();
+
+    const Box<T> &valid_box = boxes[index];
+
+    // Make corner 1 (bottom-right) and corner 2 (top-left
+    auto c1 = Corner(valid_box.x + valid_box.getWidth(), valid_box.y, C1);
+    auto c2 = Corner(valid_box.x, valid_box.y + valid_box.getHeight(), C2);
+    c1.owner = c2.owner = index;
+
+    // And their projections
+    auto cx = Corner(c2, CX);
+    auto cy = Corner(c1, CY);
+
+    double saved_x = 0, saved_y = 0;
+    for (const Box<T> &other : boxes) {
+      if (valid_box.id == other.id)
+        continue;
+
+      // For Cx
+      if ((other.y < cx.y) && (cx.y < other.y + other.getHeight())) {
+        saved_x = ((other.x + other.getWidth() > saved_x) &&
+                   (other.x + other.getWidth() <= cx.x))
+                      ? other.x + other.getWidth()
+                      : saved_x;
+      }
+
+      // For Cy
+      if ((other.x < cy.x) && (cy.x < other.x + other.getWidth())) {
+        saved_y = ((other.y + other.getHeight() > saved_y) &&
+                   (other.y + other.getHeight() <= cy.y))
+                      ? other.y + other.getHeight()
+                      : saved_y;
+      }
+    }
+    cx.x = saved_x;
+    cy.y = saved_y;
+
+    bool use_cx = !(cx.x == c2.x);
+    bool use_cy = !(cy.y == c1.y);
+
+    // Project corners
+    bool c1_on_another = false, c1_taken = false;
+    bool c2_in_corner = false, c2_taken = false;
+    bool cx_taken = false, cy_taken = false;
+
+    // Test if corners are valid
+    c1_on_another = (c1.y == 0);
+    c2_in_corner = (c2.x == 0);
+    for (const Box<T> &other : boxes) {
+      if (valid_box.id == other.id)
+        continue;
+
+      // For C1
+      c1_on_another =
+          c1_on_another ||
+          ((c1.x > other.x) && (c1.x < other.x + other.getWidth()) &&
+           (std::fabs(c1.y - other.y - other.getHeight()) < STHRES));
+      c1_taken = c1_taken || (std::fabs(c1.x - other.x) < STHRES &&
+                              std::fabs(c1.y - other.y) < STHRES);
+
+      // For C2
+      c2_in_corner =
+          c2_in_corner ||
+          ((std::fabs(c2.x - other.x - other.getWidth()) < STHRES) &&
+           (c2.y > other.y) && (c2.y < other.y + other.getHeight()));
+      c2_taken = c2_taken || (std::fabs(c2.x - other.x) < STHRES &&
+                              std::fabs(c2.y - other.y) < STHRES);
+
+      cx_taken = cx_taken || (std::fabs(cx.x - other.x) < STHRES &&
+                              std::fabs(cx.y - other.y) < STHRES);
+      cy_taken = cy_taken || (std::fabs(cy.x - other.x) < STHRES &&
+                              std::fabs(cy.y - other.y) < STHRES);
+    }
+
+    // If they are, add them
+    if (c1_on_another && !c1_taken)
+      box_corners[index].push_back(c1);
+    if (c2_in_corner && !c2_taken)
+      box_corners[index].push_back(c2);
+    if (use_cx && !cx_taken)
+      box_corners[index].push_back(cx);
+    if (use_cy && !cy_taken)
+      box_corners[index].push_back(cy);
+    corners.insert(box_corners[index].begin(), box_corners[index].end());
+  }
 };
 
 } // namespace kami::packing
@@ -1,9 +1,10 @@
 #ifndef KAMI_PACKING_BOX
 #define KAMI_PACKING_BOX
 
+#include "kami/math/base_types.hpp"
 #include "kami/math/bounds.hpp"
-#include "kami/math/edge.hpp"
-#include "kami/math/vertex.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace kami::packing {
 template <typename T> struct Box {
@@ -25,46 +26,36 @@ template <typename T> struct Box {
 
   double getWidth() const { return (rotated) ? height : width; }
   double getHeight() const { return (rotated) ? width : height; }
-  math::Edge getEdge(int edge) const {
-    switch (edge + 1) {
-    case 2:
-      return math::Edge{math::Vertex{x + getWidth(), y, 0},
-                        math::Vertex{x + getWidth(), y + getHeight(), 0}};
-    case 3:
-      return math::Edge{math::Vertex{x, y + getHeight(), 0},
-                        math::Vertex{x + getWidth(), y + getHeight(), 0}};
-    case 4:
-      return math::Edge{math::Vertex{x, y, 0},
-                        math::Vertex{x, y + getHeight(), 0}};
-    default:
-      return math::Edge{math::Vertex{x, y, 0},
-                        math::Vertex{x + getWidth(), y, 0}};
-    }
+  /**
+   * @brief Test whether the insides of the boxes overlap, boxes only touching
+   * each other do not
+   */
+  bool overlaps(const Box<T> &other) const {
+    const double t = math::SIMPLIFICATION_THRESHOLD;
+    return (x + t < other.x + other.getWidth()) &&
+           (other.x + t < x + getWidth()) &&
+           (y + t < other.y + other.getHeight()) &&
+           (other.y + t < y + getHeight());
   }
 
-  bool isColiding(const Box<T> &other) const {
-    bool isColiding = false;
+  /**
+   * @brief Length of the sides shared by two boxes touching each other
+   */
+  double getContactLength(const Box<T> &other) const {
+    const double t = math::SIMPLIFICATION_THRESHOLD;
+    double dx = std::min(x + getWidth(), other.x + other.getWidth()) -
+                std::max(x, other.x);
+    double dy = std::min(y + getHeight(), other.y + other.getHeight()) -
+                std::max(y, other.y);
 
-    // Test if a boxe is in another
-    isColiding =
-        ((x <= other.x) && (x + getWidth() >= other.x + other.getWidth()) &&
-         (y <= other.y) && (y + getHeight() >= other.y + other.getHeight()));
-    isColiding =
-        isColiding ||
-        ((x >= other.x) && (x + getWidth() <= other.x + other.getWidth()) &&
-         (y >= other.y) && (y + getHeight() <= other.y + other.getHeight()));
-
-    // Test coliding edges
-    for (int i = 0; (i < 4) && !isColiding; i++) {
-      for (int j = 0; (j < 4) && !isColiding; j++) {
-        auto params = math::Edge::findIntersect(getEdge(i), other.getEdge(j));
-        isColiding = ((math::Edge::VERTEX_AREA < params.t &&
-                       params.t < 1 - math::Edge::VERTEX_AREA) &&
-                      (math::Edge::VERTEX_AREA < params.s &&
-                       params.s < 1 - math::Edge::VERTEX_AREA));
-      }
-    }
-    return isColiding;
+    double length = 0;
+    if (dy > 0 && (std::fabs(x + getWidth() - other.x) < t ||
+                   std::fabs(other.x + other.getWidth() - x) < t))
+      length += dy;
+    if (dx > 0 && (std::fabs(y + getHeight() - other.y) < t ||
+                   std::fabs(other.y + other.getHeight() - y) < t))
+      length += dx;
+    return length;
   }
 
   friend std::ostream &operator<<(std::ostream &os, Box &box) {
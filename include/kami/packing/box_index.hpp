@@ -0,0 +1,84 @@
+#ifndef KAMI_PACKING_BOX_INDEX
+#define KAMI_PACKING_BOX_INDEX
+
+#include "kami/export/paper_format.hpp"
+#include "kami/math/base_types.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace kami::packing {
+
+/**
+ * @brief Uniform grid over a bin, each cell listing the boxes whose rectangle
+ * covers it. Queries only visit the boxes near the searched rectangle.
+ */
+class BoxIndex {
+public:
+  static constexpr int CELLS{16}; //< Cells along each side of the bin
+
+  BoxIndex(const out::PaperFormat &format)
+      : cell_w(format.width / CELLS), cell_h(format.height / CELLS),
+        cells(CELLS * CELLS) {}
+
+  /**
+   * @brief Add a rectangle, its index being the number of rectangles added
+   * before it
+   */
+  void insert(double x, double y, double w, double h) {
+    Range range = getRange(x, y, w, h);
+    ranges.push_back(range);
+    for (int j = range.j0; j <= range.j1; j++) {
+      for (int i = range.i0; i <= range.i1; i++)
+        cells[j * CELLS + i].push_back(ranges.size() - 1);
+    }
+  }
+
+  /**
+   * @brief Call f with the index of each rectangle sharing a cell with the
+   * given one (touching it or closer), once each. The search stops when f
+   * returns false.
+   *
+   * @return false if the search was stopped
+   */
+  template <typename F>
+  bool forEachNear(double x, double y, double w, double h, F &&f) const {
+    Range range = getRange(x, y, w, h);
+    for (int j = range.j0; j <= range.j1; j++) {
+      for (int i = range.i0; i <= range.i1; i++) {
+        for (ulong index : cells[j * CELLS + i]) {
+          // Only in the first cell both rectangles cover
+          const Range &other = ranges[index];
+          if (i != std::max(range.i0, other.i0) ||
+              j != std::max(range.j0, other.j0))
+            continue;
+          if (!f(index))
+            return false;
+        }
+      }
+    }
+    return true;
+  }
+
+private:
+  struct Range {
+    int i0, j0, i1, j1;
+  };
+
+  Range getRange(double x, double y, double w, double h) const {
+    auto cell = [](double v, double size) {
+      return std::clamp((int)std::floor(v / size), 0, CELLS - 1);
+    };
+    const double margin = math::SIMPLIFICATION_THRESHOLD;
+    return Range{cell(x - margin, cell_w), cell(y - margin, cell_h),
+                 cell(x + w + margin, cell_w), cell(y + h + margin, cell_h)};
+  }
+
+  double cell_w, cell_h;
+  std::vector<std::vector<ulong>> cells;
+  std::vector<Range> ranges;
+};
+
+} // namespace kami::packing
+
+#endif
@@ -2,6 +2,8 @@
 #define KAMI_PACKING_CORNER
 
 #include <ostream>
+#include <string>
+#include <tuple>
 
 namespace kami::packing {
 
@@ -10,16 +12,28 @@ enum CornerType { C1, C2, CX, CY, CXY };
 struct Corner {
   CornerType type;
   double x = 0, y = 0;
+  long owner = -1; //< Index of the box which made the corner in its bin
 
   Corner() : x(0), y(0), type(C1){};
   Corner(double _x, double _y, CornerType _type) : x(_x), y(_y), type(_type) {}
   Corner(const Corner &other, CornerType _type)
-      : x(other.x), y(other.y), type(_type) {}
+      : x(other.x), y(other.y), type(_type), owner(other.owner) {}
 
-  static bool compare(Corner c1, Corner c2) {
-    return (c1.y <= c2.y) ? (c1.x < c2.x) : false;
+  /**
+   * @brief Order the corners from the bottom to the top, then from the left to
+   * the right (strict weak ordering)
+   */
+  static bool compare(const Corner &c1, const Corner &c2) {
+    return std::tie(c1.y, c1.x, c1.type, c1.owner) <
+           std::tie(c2.y, c2.x, c2.type, c2.owner);
   }
 
+  struct Less {
+    bool operator()(const Corner &c1, const Corner &c2) const {
+      return compare(c1, c2);
+    }
+  };
+
   std::string getStrokeColor() const {
     switch (type) {
     case C1:
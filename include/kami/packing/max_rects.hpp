@@ -0,0 +1,145 @@
+#ifndef KAMI_PACKING_MAX_RECTS
+#define KAMI_PACKING_MAX_RECTS
+
+#include "kami/export/paper_format.hpp"
+#include "kami/math/edge.hpp"
+#include "kami/packing/box.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace kami::packing {
+
+/**
+ * @brief Free space of a bin for the MaxRects algorithm, kept as the list of
+ * the maximal free rectangles. They may overlap each other, but none is held
+ * by another one.
+ *
+ * Jukka Jylänki, (2010) A Thousand Ways to Pack the Bin - A Practical Approach
+ * to Two-Dimensional Rectangle Bin Packing.
+ */
+template <typename T> class MaxRects {
+public:
+  struct Rect {
+    double x, y, w, h;
+
+    bool intersects(const Rect &o) const {
+      return (x + math::SIMPLIFICATION_THRESHOLD < o.x + o.w) &&
+             (o.x + math::SIMPLIFICATION_THRESHOLD < x + w) &&
+             (y + math::SIMPLIFICATION_THRESHOLD < o.y + o.h) &&
+             (o.y + math::SIMPLIFICATION_THRESHOLD < y + h);
+    }
+    bool isIn(const Rect &o) const {
+      return (o.x - math::SIMPLIFICATION_THRESHOLD <= x) &&
+             (o.y - math::SIMPLIFICATION_THRESHOLD <= y) &&
+             (x + w <= o.x + o.w + math::SIMPLIFICATION_THRESHOLD) &&
+             (y + h <= o.y + o.h + math::SIMPLIFICATION_THRESHOLD);
+    }
+  };
+
+  /**
+   * @brief Position of a box in a free rectangle, scored by the leftover sides
+   * of the rectangle (Best Short Side Fit, then the long side)
+   */
+  struct Fit {
+    size_t rect = 0;
+    bool rotated = false;
+    double short_side = -1, long_side = -1;
+
+    bool isValid() const { return short_side >= 0; }
+    bool isBetter(const Fit &o) const {
+      if (!o.isValid())
+        return isValid();
+      return isValid() &&
+             ((short_side < o.short_side) ||
+              (short_side == o.short_side && long_side < o.long_side));
+    }
+  };
+
+  MaxRects(const out::PaperFormat &format) {
+    free.push_back(Rect{0, 0, format.width, format.height});
+  }
+
+  /**
+   * @brief Find the best position of the box among the free rectangles, as is
+   * or rotated. The returned fit is invalid when the box fits nowhere.
+   */
+  Fit findPosition(const Box<T> &box) const {
+    Fit best;
+    for (size_t i = 0; i < free.size(); i++) {
+      for (bool rotated : {false, true}) {
+        double w = (rotated) ? box.height : box.width;
+        double h = (rotated) ? box.width : box.height;
+        if (w > free[i].w || h > free[i].h)
+          continue;
+
+        Fit fit;
+        fit.rect = i;
+        fit.rotated = rotated;
+        fit.short_side = std::min(free[i].w - w, free[i].h - h);
+        fit.long_side = std::max(free[i].w - w, free[i].h - h);
+        if (fit.isBetter(best))
+          best = fit;
+      }
+    }
+    return best;
+  }
+
+  /**
+   * @brief Place the box on the bottom-left corner of the free rectangle of the
+   * fit, then split the free rectangles it overlaps into the maximal ones
+   * around it.
+   */
+  void place(Box<T> &box, const Fit &fit) {
+    box.x = free[fit.rect].x;
+    box.y = free[fit.rect].y;
+    box.rotated = fit.rotated;
+    Rect used{box.x, box.y, box.getWidth(), box.getHeight()};
+
+    std::vector<Rect> kept, created;
+    kept.reserve(free.size());
+    for (const Rect &f : free) {
+      if (!used.intersects(f)) {
+        kept.push_back(f);
+        continue;
+      }
+      if (used.x > f.x + math::SIMPLIFICATION_THRESHOLD)
+        created.push_back(Rect{f.x, f.y, used.x - f.x, f.h});
+      if (used.x + used.w < f.x + f.w - math::SIMPLIFICATION_THRESHOLD)
+        created.push_back(
+            Rect{used.x + used.w, f.y, f.x + f.w - used.x - used.w, f.h});
+      if (used.y > f.y + math::SIMPLIFICATION_THRESHOLD)
+        created.push_back(Rect{f.x, f.y, f.w, used.y - f.y});
+      if (used.y + used.h < f.y + f.h - math::SIMPLIFICATION_THRESHOLD)
+        created.push_back(
+            Rect{f.x, used.y + used.h, f.w, f.y + f.h - used.y - used.h});
+    }
+
+    // The kept rectangles were maximal and the created ones are parts of the
+    // split ones: only the created ones can be held by another rectangle
+    free.swap(kept);
+    for (size_t i = 0; i < created.size(); i++) {
+      bool held = false;
+      for (size_t j = 0; (j < created.size()) && !held; j++)
+        held = (i != j) && created[i].isIn(created[j]) &&
+               (!created[j].isIn(created[i]) || j < i);
+      for (size_t j = 0; (j < free.size()) && !held; j++)
+        held = created[i].isIn(free[j]);
+      if (!held)
+        free.push_back(created[i]);
+    }
+  }
+
+  /**
+   * @brief Mark the whole bin as used, for a box too big for any bin
+   */
+  void fill() { free.clear(); }
+
+  size_t getFreeCount() const { return free.size(); }
+
+private:
+  std::vector<Rect> free;
+};
+
+} // namespace kami::packing
+
+#endif
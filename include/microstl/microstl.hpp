@@ -15,6 +15,7 @@
 #include <sstream>
 #include <streambuf>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace microstl {
@@ -787,18 +788,26 @@ struct FVMeshProvider : microstl::Writer::Provider {
 };
 
 // Deduplicates the vertices to create a more common face-vertex data structure
+// Vertices are matched exactly through a hash map on their coordinates
 inline FVMesh deduplicateVertices(const Mesh &inputMesh) {
-  FVMesh outputMesh;
-  auto addVertex = [&outputMesh](const Vertex &v) {
-    for (size_t i = 0; i < outputMesh.vertices.size(); i++) {
-      if (v.x == outputMesh.vertices[i].x && v.y == outputMesh.vertices[i].y &&
-          v.z == outputMesh.vertices[i].z) {
-        return i;
-      }
+  struct VertexKeyHash {
+    size_t operator()(const std::array<uint32_t, 3> &k) const {
+      return (k[0] * 73856093u) ^ (k[1] * 19349663u) ^ (k[2] * 83492791u);
     }
-    size_t index = outputMesh.vertices.size();
-    outputMesh.vertices.push_back(v);
-    return index;
+  };
+  FVMesh outputMesh;
+  std::unordered_map<std::array<uint32_t, 3>, size_t, VertexKeyHash> indices;
+  indices.reserve(inputMesh.facets.size());
+  outputMesh.facets.reserve(inputMesh.facets.size());
+  auto addVertex = [&outputMesh, &indices](const Vertex &v) {
+    // Adding 0 turns -0 into +0 so that both share the same key
+    const float coords[3] = {v.x + 0.0f, v.y + 0.0f, v.z + 0.0f};
+    std::array<uint32_t, 3> key;
+    memcpy(key.data(), coords, sizeof(coords));
+    auto inserted = indices.try_emplace(key, outputMesh.vertices.size());
+    if (inserted.second)
+      outputMesh.vertices.push_back(v);
+    return inserted.first->second;
   };
   for (const auto &f : inputMesh.facets) {
     size_t i1 = addVertex(f.v1);
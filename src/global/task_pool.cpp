@@ -0,0 +1,101 @@
+#include "kami/global/task_pool.hpp"
+#include <algorithm>
+
+namespace kami {
+
+// Index of the worker running on this thread, 0 outside of the pool threads
+static thread_local size_t current_worker = 0;
+
+TaskPool::TaskPool(size_t n_threads) {
+  n_threads = std::max<size_t>(1, n_threads);
+  for (size_t i = 0; i < n_threads; i++)
+    queues.push_back(std::make_unique<Queue>());
+  for (size_t i = 1; i < n_threads; i++)
+    threads.emplace_back(&TaskPool::work, this, i);
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto &thread : threads)
+    thread.join();
+}
+
+void TaskPool::submit(Task task) {
+  pending++;
+  {
+    Queue &queue = *queues[current_worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    queued++;
+  }
+  wake.notify_one();
+}
+
+bool TaskPool::pop(size_t worker, Task &task) {
+  for (size_t k = 0; k < queues.size(); k++) {
+    Queue &queue = *queues[(worker + k) % queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+      continue;
+    if (k == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    queued--;
+    return true;
+  }
+  return false;
+}
+
+void TaskPool::execute(Task &task) {
+  task();
+  if (--pending == 0) {
+    std::lock_guard<std::mutex> lock(sleep_mutex);
+    wake.notify_all();
+  }
+}
+
+void TaskPool::work(size_t worker) {
+  current_worker = worker;
+  Task task;
+  while (true) {
+    if (pop(worker, task)) {
+      execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    wake.wait(lock, [this] { return stopping || queued > 0; });
+    if (stopping)
+      return;
+  }
+}
+
+void TaskPool::run(Task root) {
+  current_worker = 0;
+  submit(std::move(root));
+
+  // The caller works as the worker 0 until everything is done
+  Task task;
+  while (pending > 0) {
+    if (pop(0, task)) {
+      execute(task);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(sleep_mutex);
+    wake.wait(lock, [this] { return pending == 0 || queued > 0; });
+  }
+}
+
+} // namespace kami
@@ -0,0 +1,42 @@
+#include "kami/io/mapped_file.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kami::io {
+
+bool MappedFile::open(const std::string &path) {
+  close();
+
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+    ::close(fd);
+    return false;
+  }
+
+  void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED)
+    return false;
+
+  // The records are read once from start to end
+  madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+
+  _data = ptr;
+  _size = st.st_size;
+  return true;
+}
+
+void MappedFile::close() {
+  if (_data != nullptr)
+    munmap(_data, _size);
+  _data = nullptr;
+  _size = 0;
+}
+
+} // namespace kami::io
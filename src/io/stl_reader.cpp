@@ -0,0 +1,238 @@
+#include "kami/io/stl_reader.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <thread>
+
+namespace kami::io {
+
+// ==========================================================================
+// Loading
+// ==========================================================================
+
+microstl::Result StlMesh::load(const std::string &path) {
+  _records = nullptr;
+  _count = 0;
+  _parsed.resize(0);
+
+  if (!_file.open(path))
+    return microstl::Result::FileError;
+
+  _ascii = isAsciiFile();
+  return (_ascii) ? loadAscii() : loadBinary();
+}
+
+bool StlMesh::isAsciiFile() const {
+  // A binary file whose size matches its facet count is binary, whatever its
+  // header says
+  if (_file.size() >= BINARY_PREAMBLE_SIZE) {
+    uint32_t count;
+    std::memcpy(&count, _file.data() + BINARY_HEADER_SIZE, sizeof(count));
+    if (_file.size() == BINARY_PREAMBLE_SIZE + count * BINARY_RECORD_SIZE)
+      return false;
+  }
+
+  // Same heuristic as microstl
+  std::string str(_file.data(), std::min<size_t>(_file.size(), 256));
+  std::transform(str.begin(), str.end(), str.begin(),
+                 [](char c) { return std::tolower(c); });
+  return (str.find("solid") != std::string::npos) &&
+         (str.find('\n') != std::string::npos) &&
+         (str.find("facet") != std::string::npos) &&
+         (str.find("normal") != std::string::npos);
+}
+
+microstl::Result StlMesh::loadBinary() {
+  const uint16_t endian_test = 1;
+  if (*reinterpret_cast<const uint8_t *>(&endian_test) != 1)
+    return microstl::Result::EndianError;
+
+  if (_file.size() < BINARY_PREAMBLE_SIZE)
+    return microstl::Result::MissingDataError;
+
+  uint32_t count;
+  std::memcpy(&count, _file.data() + BINARY_HEADER_SIZE, sizeof(count));
+  if (count == 0)
+    return microstl::Result::MissingDataError;
+  if (count > microstl::Reader::BINARY_FACET_LIMIT)
+    return microstl::Result::FacetCountError;
+  if (_file.size() < BINARY_PREAMBLE_SIZE + count * BINARY_RECORD_SIZE)
+    return microstl::Result::MissingDataError;
+
+  _records = _file.data() + BINARY_PREAMBLE_SIZE;
+  _count = count;
+  return microstl::Result::Success;
+}
+
+// ==========================================================================
+// ASCII parsing
+// ==========================================================================
+
+/**
+ * @brief Cursor over a chunk of an ASCII STL buffer. Tokens are matched in
+ * place, without building any string.
+ */
+struct AsciiCursor {
+  const char *p, *end;
+
+  static inline bool isWhiteSpace(const char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+  inline void skipWhiteSpaces() {
+    while (p < end && isWhiteSpace(*p))
+      p++;
+  }
+
+  inline bool atEnd() {
+    skipWhiteSpaces();
+    return p >= end;
+  }
+
+  /**
+   * @brief Consume the given keyword if it is the next token
+   */
+  inline bool keyword(const char *word, size_t length) {
+    skipWhiteSpaces();
+    if ((size_t)(end - p) < length || std::memcmp(p, word, length) != 0)
+      return false;
+    if (p + length < end && !isWhiteSpace(p[length]))
+      return false;
+    p += length;
+    return true;
+  }
+
+  /**
+   * @brief Consume the next token as a float
+   */
+  inline bool number(float &value) {
+    skipWhiteSpaces();
+    if (p < end && *p == '+')
+      p++;
+    auto [ptr, ec] = std::from_chars(p, end, value);
+    if (ec != std::errc() || (ptr < end && !isWhiteSpace(*ptr)))
+      return false;
+    p = ptr;
+    return true;
+  }
+
+  inline bool threeNumbers(float v[3]) {
+    return number(v[0]) && number(v[1]) && number(v[2]);
+  }
+};
+
+#define KEYWORD(cursor, word) cursor.keyword(word, sizeof(word) - 1)
+
+/**
+ * @brief Parse all the facets between the two given positions
+ */
+static microstl::Result parseAsciiFacets(const char *begin, const char *end,
+                                         std::vector<StlFacet> &facets) {
+  AsciiCursor cursor{begin, end};
+  StlFacet facet;
+  while (!cursor.atEnd()) {
+    if (!KEYWORD(cursor, "facet") || !KEYWORD(cursor, "normal"))
+      return microstl::Result::UnexpectedError;
+    if (!cursor.threeNumbers(facet.n))
+      return microstl::Result::ParserError;
+    if (!KEYWORD(cursor, "outer") || !KEYWORD(cursor, "loop"))
+      return microstl::Result::UnexpectedError;
+    for (float *v : {facet.v1, facet.v2, facet.v3}) {
+      if (!KEYWORD(cursor, "vertex"))
+        return microstl::Result::UnexpectedError;
+      if (!cursor.threeNumbers(v))
+        return microstl::Result::ParserError;
+    }
+    if (!KEYWORD(cursor, "endloop") || !KEYWORD(cursor, "endfacet"))
+      return microstl::Result::UnexpectedError;
+    facets.push_back(facet);
+  }
+  return microstl::Result::Success;
+}
+
+/**
+ * @brief Find the first "facet" token starting at or after the given
+ * position (skipping the "endfacet" ones).
+ *
+ * @param begin the start of the buffer
+ * @param p the position to search from
+ * @param end the end of the buffer
+ */
+static const char *findFacetStart(const char *begin, const char *p,
+                                  const char *end) {
+  std::string_view view(p, end - p);
+  for (size_t pos = view.find("facet"); pos != std::string_view::npos;
+       pos = view.find("facet", pos + 1)) {
+    if (p + pos == begin || AsciiCursor::isWhiteSpace(p[pos - 1]))
+      return p + pos;
+  }
+  return end;
+}
+
+microstl::Result StlMesh::loadAscii() {
+  const char *begin = _file.data();
+  const char *end = begin + _file.size();
+
+  // Header: "solid [name]" on its own line
+  AsciiCursor header{begin, end};
+  header.skipWhiteSpaces();
+  if ((size_t)(end - header.p) < 5 || std::memcmp(header.p, "solid", 5) != 0)
+    return microstl::Result::UnexpectedError;
+  const char *facets_begin = std::find(header.p, end, '\n');
+
+  // Footer: "endsolid [name]"
+  std::string_view view(begin, end - begin);
+  size_t footer = view.rfind("endsolid");
+  if (footer == std::string_view::npos || begin + footer < facets_begin)
+    return microstl::Result::MissingDataError;
+  const char *facets_end = begin + footer;
+
+  // Split the facets on "facet normal" boundaries
+  size_t n_chunks = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          (facets_end - facets_begin) / ASCII_CHUNK_SIZE));
+  std::vector<const char *> bounds{facets_begin};
+  for (size_t i = 1; i < n_chunks; i++) {
+    const char *guess =
+        facets_begin + i * (facets_end - facets_begin) / n_chunks;
+    const char *split =
+        findFacetStart(begin, std::max(guess, bounds.back()), end);
+    bounds.push_back(std::min(split, facets_end));
+  }
+  bounds.push_back(facets_end);
+
+  // Parse each chunk on its own thread
+  std::vector<std::vector<StlFacet>> chunks(n_chunks);
+  std::vector<microstl::Result> results(n_chunks);
+  auto parse_chunk = [&](size_t i) {
+    chunks[i].reserve((bounds[i + 1] - bounds[i]) / ASCII_FACET_SIZE_HINT);
+    results[i] = parseAsciiFacets(bounds[i], bounds[i + 1], chunks[i]);
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < n_chunks; i++)
+    workers.emplace_back(parse_chunk, i);
+  parse_chunk(0);
+  for (auto &worker : workers)
+    worker.join();
+
+  // Merge them in the file order
+  for (auto result : results) {
+    if (result != microstl::Result::Success)
+      return result;
+  }
+  size_t count = 0;
+  for (auto &chunk : chunks)
+    count += chunk.size();
+  _parsed.reserve(count);
+  for (auto &chunk : chunks)
+    _parsed.insert(_parsed.end(), chunk.begin(), chunk.end());
+
+  _count = _parsed.size();
+  _file.close();
+  return (_count == 0) ? microstl::Result::MissingDataError
+                       : microstl::Result::Success;
+}
+
+} // namespace kami::io
@@ -1,5 +1,6 @@
 #include "kami/global/arguments.hpp"
 #include "kami/global/logging.hpp"
+#include "kami/io/stl_reader.hpp"
 #include "kami/mesh/linked_poly.hpp"
 #include "kami/mesh/linked_pool.hpp"
 #include "microstl/microstl.hpp"
@@ -10,13 +11,6 @@
 #include <sstream>
 #include <string>
 
-microstl::Result loadSTL(microstl::MeshReaderHandler &handler,
-                         const std::string &file_path) {
-  handler.forceNormals = true;
-  handler.disableNormals = true;
-  return microstl::Reader::readStlFile(file_path, handler);
-}
-
 int main(int argc, char **argv) {
   // Parse arguments + help
   kami::args::Args args = kami::args::getArguments(argc, argv);
@@ -35,20 +29,20 @@ int main(int argc, char **argv) {
   TIMED_UTILS;
 
   // Load STL file
-  microstl::MeshReaderHandler handler;
+  kami::io::StlMesh mesh;
   TIMED_SECTION("Loading STL file", {
-    if (microstl::Result result = loadSTL(handler, args.input);
+    if (microstl::Result result = mesh.load(args.input);
         result != microstl::Result::Success) {
       std::cout << "Couldn't load file (" << args.input
                 << "):" << microstl::getResultString(result) << std::endl;
       return -1;
     }
-    std::cout << "\tLoaded " << handler.mesh.facets.size() << " facets"
-              << std::endl;
+    std::cout << "\tLoaded " << mesh.size() << " facets"
+              << ((mesh.isAscii()) ? " (ASCII)" : " (Binary)") << std::endl;
   });
 
   // Make the linking pool
-  auto pool = kami::LinkedMeshPool(handler.mesh);
+  auto pool = kami::LinkedMeshPool(mesh);
 
   // Informations for debug
   printSectionHeader("Raw Mesh Properties (Link + Merge)");
@@ -56,7 +50,7 @@ int main(int argc, char **argv) {
   std::cout << pool << std::endl;
 
   // Unfold the linked mesh
-  pool.unfold(args.max_depth);
+  pool.unfold(args.max_depth, args.n_threads);
   printSectionHeader("Unfold Mesh Properties");
   std::cout << pool << std::endl;
 
@@ -64,7 +58,8 @@ int main(int argc, char **argv) {
   pool.scaleFigure(args.world_scaling);
 
   // Slice the linked mesh in multiple parts
-  kami::MeshBinVector bins = pool.slice();
+  kami::MeshBinVector bins =
+      pool.slice(args.n_threads, args.slicing, args.packing);
 
   auto make_file_name = [&args](const std::string &suffix) {
     std::stringstream ss;
@@ -10,40 +10,18 @@ Bounds Edge::getBounds() const {
                   std::min(v1(2), v2(2)), std::min(v1(2), v2(2)));
 
   // Adding padding
-  b.xmin += ((b.xmin < 0) ? 1 : -1) * out::BOUNDS_PADDING * b.xmin;
-  b.xmax += ((b.xmax < 0) ? -1 : 1) * out::BOUNDS_PADDING * b.xmax;
-  b.ymin += ((b.ymin < 0) ? 1 : -1) * out::BOUNDS_PADDING * b.ymin;
-  b.ymax += ((b.ymax < 0) ? -1 : 1) * out::BOUNDS_PADDING * b.ymax;
-  b.zmin += ((b.zmin < 0) ? 1 : -1) * out::BOUNDS_PADDING * b.zmin;
-  b.zmax += ((b.zmax < 0) ? -1 : 1) * out::BOUNDS_PADDING * b.zmax;
+  b.pad(out::BOUNDS_PADDING);
   return b;
 }
 
-double Edge::overlapsLength(const Edge &e1, const Edge &e2) {
-  // If the edges are on the same x axis
-  if ((e1.v1(0) == e2.v1(0)) && (e1.v2(0) == e2.v2(0))) {
-    double start =
-        std::max(std::min(e1.v1(1), e1.v2(1)), std::min(e2.v1(1), e2.v2(1)));
-    double end =
-        std::min(std::max(e1.v1(1), e1.v2(1)), std::max(e2.v1(1), e2.v2(1)));
-    return std::fabs(end - start);
-  }
-  // If the edges are on the same y axis
-  else if ((e1.v1(1) == e2.v1(1)) && (e1.v2(1) == e2.v2(1))) {
-    double start =
-        std::max(std::min(e1.v1(0), e1.v2(0)), std::min(e2.v1(0), e2.v2(0)));
-    double end =
-        std::min(std::max(e1.v1(0), e1.v2(0)), std::max(e2.v1(0), e2.v2(0)));
-    return std::fabs(end - start);
-  }
-  return 0;
-}
-
 IntersectParams Edge::findIntersect(const Edge &e1, const Edge &e2) {
   auto u = e1.dir();
   auto v = e2.dir();
   double det = u(1) * v(0) - u(0) * v(1);
-  if (std::fabs(det) < 1E-2)
+
+  // Colinear when the sine of their angle vanishes, whatever their lengths
+  double lengths = std::hypot(u(0), u(1)) * std::hypot(v(0), v(1));
+  if (std::fabs(det) <= PARALLEL_SINE * lengths)
     return IntersectParams{-1, -1};
 
   auto dx = (e2.v1(0) - e1.v1(0)) / det;
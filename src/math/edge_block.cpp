@@ -0,0 +1,232 @@
+#include "kami/math/edge_block.hpp"
+#include <cmath>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace kami::math {
+
+// ==========================================================================
+// Crossings
+// ==========================================================================
+
+uint64_t EdgeBlock::getCrossings(const Edge &edge, size_t first, size_t n,
+                                 bool strict) const {
+  const Vertex &v1 = edge.getFirst(), &v2 = edge.getSecond();
+  const double px = v1(0), py = v1(1), qx = v2(0), qy = v2(1);
+  const double lo = Edge::VERTEX_AREA, hi = 1 - Edge::VERTEX_AREA;
+  const double ux = qx - px, uy = qy - py;
+  const double sine_bound = PARALLEL_SINE2 * (ux * ux + uy * uy);
+
+  const double *cx = x1.data() + first, *cy = y1.data() + first;
+  const double *dx = x2.data() + first, *dy = y2.data() + first;
+  uint64_t mask = 0, uncertain = 0;
+  size_t i = 0;
+
+  // Same operations as orient2d and segmentsCross. The edges with an uncertain
+  // orientation are left to the exact test.
+#if defined(__AVX__)
+  {
+    typedef __m256d V;
+    const V vpx = _mm256_set1_pd(px), vpy = _mm256_set1_pd(py);
+    const V vqx = _mm256_set1_pd(qx), vqy = _mm256_set1_pd(qy);
+    const V vlo = _mm256_set1_pd(lo), vhi = _mm256_set1_pd(hi);
+    const V vbound = _mm256_set1_pd(sine_bound);
+    const V error = _mm256_set1_pd(ORIENT_ERROR);
+    const V sign = _mm256_set1_pd(-0.0);
+    auto orient = [&](V ax, V ay, V bx, V by, V cx, V cy, V &unsure) {
+      V left = _mm256_mul_pd(_mm256_sub_pd(ax, cx), _mm256_sub_pd(by, cy));
+      V right = _mm256_mul_pd(_mm256_sub_pd(ay, cy), _mm256_sub_pd(bx, cx));
+      V det = _mm256_sub_pd(left, right);
+      V bound = _mm256_mul_pd(error, _mm256_add_pd(_mm256_andnot_pd(sign, left),
+                                                   _mm256_andnot_pd(sign, right)));
+      unsure = _mm256_or_pd(
+          unsure, _mm256_cmp_pd(_mm256_andnot_pd(sign, det), bound, _CMP_LE_OQ));
+      return det;
+    };
+    auto inWindow = [&](V t) {
+      if (strict)
+        return _mm256_and_pd(_mm256_cmp_pd(vlo, t, _CMP_LT_OQ),
+                             _mm256_cmp_pd(t, vhi, _CMP_LT_OQ));
+      return _mm256_and_pd(_mm256_cmp_pd(vlo, t, _CMP_LE_OQ),
+                           _mm256_cmp_pd(t, vhi, _CMP_LE_OQ));
+    };
+    for (; i + 4 <= n; i += 4) {
+      V vcx = _mm256_loadu_pd(cx + i), vcy = _mm256_loadu_pd(cy + i);
+      V vdx = _mm256_loadu_pd(dx + i), vdy = _mm256_loadu_pd(dy + i);
+      V unsure = _mm256_setzero_pd();
+      V o1 = orient(vpx, vpy, vqx, vqy, vcx, vcy, unsure);
+      V o2 = orient(vpx, vpy, vqx, vqy, vdx, vdy, unsure);
+      V o3 = orient(vcx, vcy, vdx, vdy, vpx, vpy, unsure);
+      V o4 = orient(vcx, vcy, vdx, vdy, vqx, vqy, unsure);
+      V t = _mm256_div_pd(o3, _mm256_sub_pd(o3, o4));
+      V s = _mm256_div_pd(o1, _mm256_sub_pd(o1, o2));
+
+      // Opposite signs on both segments, not parallel, then the window
+      V vx = _mm256_sub_pd(vdx, vcx), vy = _mm256_sub_pd(vdy, vcy);
+      V sine = _mm256_sub_pd(o1, o2);
+      V length2 = _mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy));
+      V hit = _mm256_and_pd(_mm256_xor_pd(o1, o2), _mm256_xor_pd(o3, o4));
+      hit = _mm256_and_pd(hit, _mm256_cmp_pd(_mm256_mul_pd(sine, sine),
+                                             _mm256_mul_pd(vbound, length2),
+                                             _CMP_GT_OQ));
+      hit = _mm256_and_pd(hit, _mm256_and_pd(inWindow(t), inWindow(s)));
+      uint64_t lanes_unsure = _mm256_movemask_pd(unsure);
+      mask |= (uint64_t)(_mm256_movemask_pd(hit) & ~lanes_unsure) << i;
+      uncertain |= lanes_unsure << i;
+    }
+  }
+#elif defined(__SSE2__)
+  {
+    typedef __m128d V;
+    const V vpx = _mm_set1_pd(px), vpy = _mm_set1_pd(py);
+    const V vqx = _mm_set1_pd(qx), vqy = _mm_set1_pd(qy);
+    const V vlo = _mm_set1_pd(lo), vhi = _mm_set1_pd(hi);
+    const V vbound = _mm_set1_pd(sine_bound);
+    const V error = _mm_set1_pd(ORIENT_ERROR);
+    const V sign = _mm_set1_pd(-0.0);
+    auto orient = [&](V ax, V ay, V bx, V by, V cx, V cy, V &unsure) {
+      V left = _mm_mul_pd(_mm_sub_pd(ax, cx), _mm_sub_pd(by, cy));
+      V right = _mm_mul_pd(_mm_sub_pd(ay, cy), _mm_sub_pd(bx, cx));
+      V det = _mm_sub_pd(left, right);
+      V bound = _mm_mul_pd(error, _mm_add_pd(_mm_andnot_pd(sign, left),
+                                             _mm_andnot_pd(sign, right)));
+      unsure = _mm_or_pd(unsure, _mm_cmple_pd(_mm_andnot_pd(sign, det), bound));
+      return det;
+    };
+    auto inWindow = [&](V t) {
+      if (strict)
+        return _mm_and_pd(_mm_cmplt_pd(vlo, t), _mm_cmplt_pd(t, vhi));
+      return _mm_and_pd(_mm_cmple_pd(vlo, t), _mm_cmple_pd(t, vhi));
+    };
+    for (; i + 2 <= n; i += 2) {
+      V vcx = _mm_loadu_pd(cx + i), vcy = _mm_loadu_pd(cy + i);
+      V vdx = _mm_loadu_pd(dx + i), vdy = _mm_loadu_pd(dy + i);
+      V unsure = _mm_setzero_pd();
+      V o1 = orient(vpx, vpy, vqx, vqy, vcx, vcy, unsure);
+      V o2 = orient(vpx, vpy, vqx, vqy, vdx, vdy, unsure);
+      V o3 = orient(vcx, vcy, vdx, vdy, vpx, vpy, unsure);
+      V o4 = orient(vcx, vcy, vdx, vdy, vqx, vqy, unsure);
+      V t = _mm_div_pd(o3, _mm_sub_pd(o3, o4));
+      V s = _mm_div_pd(o1, _mm_sub_pd(o1, o2));
+
+      // Opposite signs on both segments, not parallel, then the window
+      V vx = _mm_sub_pd(vdx, vcx), vy = _mm_sub_pd(vdy, vcy);
+      V sine = _mm_sub_pd(o1, o2);
+      V length2 = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+      V hit = _mm_and_pd(_mm_xor_pd(o1, o2), _mm_xor_pd(o3, o4));
+      hit = _mm_and_pd(hit, _mm_cmpgt_pd(_mm_mul_pd(sine, sine),
+                                         _mm_mul_pd(vbound, length2)));
+      hit = _mm_and_pd(hit, _mm_and_pd(inWindow(t), inWindow(s)));
+      uint64_t lanes_unsure = _mm_movemask_pd(unsure);
+      mask |= (uint64_t)(_mm_movemask_pd(hit) & ~lanes_unsure) << i;
+      uncertain |= lanes_unsure << i;
+    }
+  }
+#endif
+
+  for (; i < n; i++)
+    uncertain |= (uint64_t)1 << i;
+  for (; uncertain != 0; uncertain &= uncertain - 1) {
+    int j = __builtin_ctzll(uncertain);
+    if (segmentsCross(px, py, qx, qy, cx[j], cy[j], dx[j], dy[j], strict))
+      mask |= (uint64_t)1 << j;
+  }
+  return mask;
+}
+
+bool EdgeBlock::isCrossedBy(const Edge &edge, bool strict) const {
+  for (size_t first = 0; first < size(); first += MASK_SIZE) {
+    size_t n = (size() - first < MASK_SIZE) ? size() - first : MASK_SIZE;
+    if (getCrossings(edge, first, n, strict) != 0)
+      return true;
+  }
+  return false;
+}
+
+// ==========================================================================
+// Polygon
+// ==========================================================================
+
+Location EdgeBlock::locate(double px, double py) const {
+  int winding = 0;
+  for (size_t i = 0; i < size(); i++) {
+    double o = orient2d(x1[i], y1[i], x2[i], y2[i], px, py);
+
+    // Closer to the edge than the band, |o| being the distance times the length
+    double lx = x2[i] - x1[i], ly = y2[i] - y1[i];
+    double length2 = lx * lx + ly * ly;
+    if (std::fabs(o) <= INNER_BAND * length2) {
+      double t = ((px - x1[i]) * lx + (py - y1[i]) * ly) / length2;
+      if (-INNER_BAND <= t && t <= 1 + INNER_BAND)
+        return Location::BOUNDARY;
+    }
+
+    // Winding number, the crossings being decided by the exact signs
+    if (y1[i] <= py) {
+      if (y2[i] > py && o > 0)
+        winding++;
+    } else if (y2[i] <= py && o < 0) {
+      winding--;
+    }
+  }
+  return (winding != 0) ? Location::INSIDE : Location::OUTSIDE;
+}
+
+Vertex EdgeBlock::getInnerPoint() const {
+  // Orientation of the polygon
+  double area = 0;
+  for (size_t i = 0; i < size(); i++)
+    area += x1[i] * y2[i] - x2[i] * y1[i];
+
+  // The corner k goes from the start of the edge k - 1 to the end of the edge k
+  for (size_t k = 0; k < size(); k++) {
+    size_t prev = (k == 0) ? size() - 1 : k - 1;
+    size_t next = (k + 1 == size()) ? 0 : k + 1;
+    double ax = x1[prev], ay = y1[prev], bx = x1[k], by = y1[k];
+    double cx = x2[k], cy = y2[k];
+    double o = orient2d(ax, ay, bx, by, cx, cy);
+    if ((o > 0) != (area > 0) || o == 0)
+      continue;
+
+    // An ear holds no other vertex of the polygon
+    bool is_ear = true;
+    for (size_t j = 0; (j < size()) && is_ear; j++) {
+      if (j == prev || j == k || j == next)
+        continue;
+      double o1 = orient2d(ax, ay, bx, by, x1[j], y1[j]);
+      double o2 = orient2d(bx, by, cx, cy, x1[j], y1[j]);
+      double o3 = orient2d(cx, cy, ax, ay, x1[j], y1[j]);
+      is_ear = !((o > 0) ? (o1 >= 0 && o2 >= 0 && o3 >= 0)
+                         : (o1 <= 0 && o2 <= 0 && o3 <= 0));
+    }
+    if (is_ear)
+      return Vertex((ax + bx + cx) / 3, (ay + by + cy) / 3, 0);
+  }
+
+  // Degenerated polygon, its barycenter
+  double sx = 0, sy = 0;
+  for (size_t i = 0; i < size(); i++) {
+    sx += x1[i];
+    sy += y1[i];
+  }
+  return Vertex(sx / size(), sy / size(), 0);
+}
+
+bool EdgeBlock::overlaps(const EdgeBlock &other) const {
+  for (size_t i = 0; i < other.size(); i++) {
+    Edge edge(Vertex(other.x1[i], other.y1[i], 0),
+              Vertex(other.x2[i], other.y2[i], 0));
+    if (isCrossedBy(edge))
+      return true;
+  }
+
+  // Without crossing, the polygons are either apart or nested
+  Vertex inner = other.getInnerPoint();
+  if (locate(inner(0), inner(1)) == Location::INSIDE)
+    return true;
+  inner = getInnerPoint();
+  return other.locate(inner(0), inner(1)) == Location::INSIDE;
+}
+
+} // namespace kami::math
@@ -8,40 +8,73 @@ namespace kami::overlaps {
 // Overlaps operators
 // ==========================================================================
 
-MeshOverlaps MeshOverlaps::operator/(const MeshOverlaps &other) const {
-  MeshOverlaps out;
-  for (const Overlap &overlap : (*this)) {
-    auto elem = std::find_if(
-        other.begin(), other.end(),
-        [overlap](const Overlap &elem) { return elem == overlap; });
-    if (elem != other.end())
-      out.push_back(overlap);
+void MeshOverlaps::insert(const Overlap &overlap) {
+  if (pairs.empty() || pairs.back() < overlap) {
+    pairs.push_back(overlap);
+    return;
   }
-  return out;
+  auto it = std::lower_bound(pairs.begin(), pairs.end(), overlap);
+  if (!(*it == overlap))
+    pairs.insert(it, overlap);
 }
 
-MeshOverlaps MeshOverlaps::operator+(const MeshOverlaps &other) const {
-  MeshOverlaps out(*this);
-  for (const Overlap &overlap : other) {
-    auto elem = std::find_if(
-        this->begin(), this->end(),
-        [overlap](const Overlap &elem) { return elem == overlap; });
-    if (elem == this->end())
-      out.push_back(overlap);
+bool MeshOverlaps::meets(const MeshOverlaps &other) const {
+  auto a = pairs.begin(), b = other.pairs.begin();
+  while (a != pairs.end() && b != other.pairs.end()) {
+    if (*a < *b)
+      a++;
+    else if (*b < *a)
+      b++;
+    else
+      return true;
   }
-  return out;
+  return false;
 }
 
-MeshOverlaps MeshOverlaps::operator-(const MeshOverlaps &other) const {
-  MeshOverlaps out;
-  for (const Overlap &overlap : (*this)) {
-    auto elem = std::find_if(
-        other.begin(), other.end(),
-        [overlap](const Overlap &elem) { return elem == overlap; });
-    if (elem == other.end())
-      out.push_back(overlap);
+MeshOverlaps &MeshOverlaps::operator+=(const MeshOverlaps &other) {
+  if (other.pairs.empty())
+    return *this;
+
+  // Merge from the back, into the space made at the end of this set
+  size_t n = pairs.size();
+  pairs.resize(n + other.pairs.size(), other.pairs.front());
+  auto out = pairs.rbegin();
+  auto a = pairs.rbegin() + other.pairs.size();
+  auto b = other.pairs.rbegin();
+  while (b != other.pairs.rend()) {
+    if (a != pairs.rend() && *b < *a)
+      *out++ = *a++;
+    else
+      *out++ = *b++;
+  }
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+  return *this;
+}
+
+MeshOverlaps &MeshOverlaps::operator-=(const MeshOverlaps &other) {
+  auto out = pairs.begin();
+  auto b = other.pairs.begin();
+  for (auto a = pairs.begin(); a != pairs.end(); a++) {
+    while (b != other.pairs.end() && *b < *a)
+      b++;
+    if (b == other.pairs.end() || !(*b == *a))
+      *out++ = *a;
+  }
+  pairs.erase(out, pairs.end());
+  return *this;
+}
+
+MeshOverlaps &MeshOverlaps::operator/=(const MeshOverlaps &other) {
+  auto out = pairs.begin();
+  auto b = other.pairs.begin();
+  for (auto a = pairs.begin(); a != pairs.end(); a++) {
+    while (b != other.pairs.end() && *b < *a)
+      b++;
+    if (b != other.pairs.end() && *b == *a)
+      *out++ = *a;
   }
-  return out;
+  pairs.erase(out, pairs.end());
+  return *this;
 }
 
 std::ostream &operator<<(std::ostream &os, MeshOverlaps &over) {
@@ -52,4 +85,4 @@ std::ostream &operator<<(std::ostream &os, MeshOverlaps &over) {
   return os;
 }
 
-} // namespace kami::overlaps
\ No newline at end of file
+} // namespace kami::overlaps
@@ -0,0 +1,120 @@
+#include "kami/math/predicates.hpp"
+#include <cmath>
+
+namespace kami::math {
+
+// ==========================================================================
+// Exact arithmetic
+// ==========================================================================
+
+// Error-free transformations: the exact result is x + y, x being the rounded
+// one. The expansions are sums of such doubles, by increasing magnitude.
+
+static inline void twoSum(double a, double b, double &x, double &y) {
+  x = a + b;
+  double b_virt = x - a;
+  double a_virt = x - b_virt;
+  y = (a - a_virt) + (b - b_virt);
+}
+
+static inline void twoDiff(double a, double b, double &x, double &y) {
+  x = a - b;
+  double b_virt = a - x;
+  double a_virt = x + b_virt;
+  y = (a - a_virt) + (b_virt - b);
+}
+
+static inline void twoProduct(double a, double b, double &x, double &y) {
+  x = a * b;
+  y = std::fma(a, b, -x);
+}
+
+/**
+ * @brief Add a double to the expansion e of n terms, in place. The expansion
+ * must have room for one more term.
+ */
+static inline int growExpansion(double *e, int n, double b) {
+  double q = b;
+  for (int i = 0; i < n; i++)
+    twoSum(q, e[i], q, e[i]);
+  e[n] = q;
+  return n + 1;
+}
+
+double orient2dExact(double ax, double ay, double bx, double by, double cx,
+                     double cy) {
+  // Each difference is exactly two doubles, each product of two of them four
+  // products of exactly two doubles
+  double acx[2], bcy[2], acy[2], bcx[2];
+  twoDiff(ax, cx, acx[1], acx[0]);
+  twoDiff(by, cy, bcy[1], bcy[0]);
+  twoDiff(ay, cy, acy[1], acy[0]);
+  twoDiff(bx, cx, bcx[1], bcx[0]);
+
+  double det[16];
+  int n = 0;
+  for (int i = 0; i < 2; i++) {
+    for (int j = 0; j < 2; j++) {
+      double x, y;
+      twoProduct(acx[i], bcy[j], x, y);
+      n = growExpansion(det, n, y);
+      n = growExpansion(det, n, x);
+      twoProduct(acy[i], bcx[j], x, y);
+      n = growExpansion(det, n, -y);
+      n = growExpansion(det, n, -x);
+    }
+  }
+
+  // The largest non-zero term gives the sign
+  for (int i = n - 1; i >= 0; i--) {
+    if (det[i] != 0)
+      return det[i];
+  }
+  return 0;
+}
+
+// ==========================================================================
+// Filtered predicates
+// ==========================================================================
+
+double orient2d(double ax, double ay, double bx, double by, double cx,
+                double cy) {
+  double detleft = (ax - cx) * (by - cy);
+  double detright = (ay - cy) * (bx - cx);
+  double det = detleft - detright;
+  double bound = ORIENT_ERROR * (std::fabs(detleft) + std::fabs(detright));
+  if (det > bound || -det > bound)
+    return det;
+  return orient2dExact(ax, ay, bx, by, cx, cy);
+}
+
+bool segmentsCross(double ax, double ay, double bx, double by, double cx,
+                   double cy, double dx, double dy, bool strict) {
+  // c and d on both sides of (a, b), then a and b on both sides of (c, d)
+  double o1 = orient2d(ax, ay, bx, by, cx, cy);
+  double o2 = orient2d(ax, ay, bx, by, dx, dy);
+  if (!((o1 < 0 && o2 > 0) || (o1 > 0 && o2 < 0)))
+    return false;
+  double o3 = orient2d(cx, cy, dx, dy, ax, ay);
+  double o4 = orient2d(cx, cy, dx, dy, bx, by);
+  if (!((o3 < 0 && o4 > 0) || (o3 > 0 && o4 < 0)))
+    return false;
+
+  // Almost parallel segments, such as the two copies of an edge shared by two
+  // facets, do not cross: o1 - o2 is the sine of their angle times their
+  // lengths
+  double ux = bx - ax, uy = by - ay, vx = dx - cx, vy = dy - cy;
+  double sine = o1 - o2;
+  if (sine * sine <=
+      (PARALLEL_SINE2 * (ux * ux + uy * uy)) * (vx * vx + vy * vy))
+    return false;
+
+  // The orientations vary linearly along the segments
+  const double lo = Edge::VERTEX_AREA, hi = 1 - Edge::VERTEX_AREA;
+  double t = o3 / (o3 - o4), s = o1 / (o1 - o2);
+  if (strict)
+    return lo < t && t < hi && lo < s && s < hi;
+  return lo <= t && t <= hi && lo <= s && s <= hi;
+}
+
+} // namespace kami::math
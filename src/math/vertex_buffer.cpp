@@ -0,0 +1,108 @@
+#include "kami/math/vertex_buffer.hpp"
+#include "kami/export/out_settings.hpp"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace kami::math {
+
+void VertexBuffer::transform(const RigidTrsf &trsf, size_t first, size_t n) {
+  const Mat3 mat = trsf.s * trsf.R;
+  const double m00 = mat(0, 0), m01 = mat(0, 1), m02 = mat(0, 2);
+  const double m10 = mat(1, 0), m11 = mat(1, 1), m12 = mat(1, 2);
+  const double m20 = mat(2, 0), m21 = mat(2, 1), m22 = mat(2, 2);
+  const double t0 = trsf.t(0), t1 = trsf.t(1), t2 = trsf.t(2);
+
+  double *px = x.data() + first, *py = y.data() + first, *pz = z.data() + first;
+  for (size_t i = 0; i < n; i++) {
+    const double vx = px[i], vy = py[i], vz = pz[i];
+    px[i] = m00 * vx + m01 * vy + m02 * vz + t0;
+    py[i] = m10 * vx + m11 * vy + m12 * vz + t1;
+    pz[i] = m20 * vx + m21 * vy + m22 * vz + t2;
+  }
+}
+
+void VertexBuffer::unfold(const Vec3 &origin, const Vec3 &x_axis,
+                          const Vec3 &y_axis, const Rigid2D &place,
+                          size_t first, size_t n) {
+  double *px = x.data() + first, *py = y.data() + first, *pz = z.data() + first;
+  for (size_t i = 0; i < n; i++) {
+    const double dx = px[i] - origin(0), dy = py[i] - origin(1),
+                 dz = pz[i] - origin(2);
+    const double u = x_axis(0) * dx + x_axis(1) * dy + x_axis(2) * dz;
+    const double v = y_axis(0) * dx + y_axis(1) * dy + y_axis(2) * dz;
+    px[i] = place.applyX(u, v);
+    py[i] = place.applyY(u, v);
+    pz[i] = 0;
+  }
+}
+
+/**
+ * @brief Get the minimum and the maximum of the n > 0 values, two at a time
+ * when SSE2 is available
+ */
+static void minMax(const double *values, size_t n, double &min, double &max) {
+  size_t i = 0;
+  min = max = values[0];
+#ifdef __SSE2__
+  if (n >= 2) {
+    __m128d lo = _mm_loadu_pd(values), hi = lo;
+    for (i = 2; i + 2 <= n; i += 2) {
+      __m128d v = _mm_loadu_pd(values + i);
+      lo = _mm_min_pd(v, lo);
+      hi = _mm_max_pd(v, hi);
+    }
+    double l[2], h[2];
+    _mm_storeu_pd(l, lo);
+    _mm_storeu_pd(h, hi);
+    min = (l[1] < l[0]) ? l[1] : l[0];
+    max = (h[1] > h[0]) ? h[1] : h[0];
+  }
+#endif
+  for (; i < n; i++) {
+    min = (values[i] < min) ? values[i] : min;
+    max = (values[i] > max) ? values[i] : max;
+  }
+}
+
+Bounds VertexBuffer::getExtent(size_t first, size_t n) const {
+  Bounds e;
+  minMax(x.data() + first, n, e.xmin, e.xmax);
+  minMax(y.data() + first, n, e.ymin, e.ymax);
+  minMax(z.data() + first, n, e.zmin, e.zmax);
+  return e;
+}
+
+Bounds VertexBuffer::getBounds(size_t first, size_t n,
+                              const RigidTrsf &trsf) const {
+  if (n == 0)
+    return Bounds();
+  if (trsf.isAxisAligned())
+    return getBounds(getExtent(first, n), trsf);
+
+  double min[3], max[3];
+  for (size_t i = first; i < first + n; i++) {
+    Vec3 p = trsf.apply(Vec3{x[i], y[i], z[i]});
+    for (int a = 0; a < 3; a++) {
+      if (i == first || p(a) < min[a])
+        min[a] = p(a);
+      if (i == first || p(a) > max[a])
+        max[a] = p(a);
+    }
+  }
+
+  auto b = Bounds(min[0], max[0], min[1], max[1], min[2], max[2]);
+  b.pad(out::BOUNDS_PADDING);
+  return b;
+}
+
+Bounds VertexBuffer::getBounds(const Bounds &extent, const RigidTrsf &trsf) {
+  Vec3 min = trsf.apply(Vec3{extent.xmin, extent.ymin, extent.zmin});
+  Vec3 max = trsf.apply(Vec3{extent.xmax, extent.ymax, extent.zmax});
+  auto b = Bounds(min(0), max(0), min(1), max(1), min(2), max(2));
+  b.pad(out::BOUNDS_PADDING);
+  return b;
+}
+
+} // namespace kami::math
@@ -0,0 +1,70 @@
+#include "kami/mesh/dual_graph.hpp"
+#include "kami/mesh/linked_poly.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace kami {
+
+// ==========================================================================
+// Construction
+// ==========================================================================
+
+/**
+ * @brief Faces sharing an undirected edge (at most two are kept)
+ */
+struct EdgeFaces {
+  static constexpr uint32_t NO_FACE{UINT32_MAX};
+
+  uint32_t face[2] = {NO_FACE, NO_FACE};
+  uint32_t edge[2] = {0, 0};
+};
+
+inline uint64_t undirectedKey(math::VertexId v1, math::VertexId v2) {
+  return (v1 < v2) ? (((uint64_t)v1 << 32) | v2) : (((uint64_t)v2 << 32) | v1);
+}
+
+DualGraph::DualGraph(const PolygonArena<LinkedPolygon> &pool)
+    : offsets(pool.size() + 1, 0) {
+  // Register every edge in the map
+  size_t n_edges = pool.edges.size();
+
+  std::unordered_map<uint64_t, EdgeFaces> edges;
+  edges.reserve(n_edges);
+  for (uint32_t f = 0; f < pool.size(); f++) {
+    auto poly_edges = pool[f].getEdges(pool);
+    for (uint32_t e = 0; e < poly_edges.size(); e++) {
+      auto &entry = edges[undirectedKey(poly_edges[e].getFirstId(),
+                                        poly_edges[e].getSecondId())];
+      int side = (entry.face[0] == EdgeFaces::NO_FACE) ? 0 : 1;
+      if (entry.face[side] == EdgeFaces::NO_FACE) {
+        entry.face[side] = f;
+        entry.edge[side] = e;
+      }
+    }
+  }
+
+  // Make the rows, sorted by neighbour index
+  links.reserve(n_edges);
+  for (uint32_t f = 0; f < pool.size(); f++) {
+    auto poly_edges = pool[f].getEdges(pool);
+    for (uint32_t e = 0; e < poly_edges.size(); e++) {
+      uint64_t key = undirectedKey(poly_edges[e].getFirstId(),
+                                   poly_edges[e].getSecondId());
+      const auto &entry = edges.find(key)->second;
+      for (int side = 0; side < 2; side++) {
+        if (entry.face[side] == f && entry.edge[side] == e &&
+            entry.face[1 - side] != EdgeFaces::NO_FACE)
+          links.push_back(
+              Link{entry.face[1 - side], e, entry.edge[1 - side]});
+      }
+    }
+    offsets[f + 1] = links.size();
+    std::sort(links.begin() + offsets[f], links.end(),
+              [](const Link &l1, const Link &l2) {
+                return (l1.face < l2.face) ||
+                       (l1.face == l2.face && l1.edge < l2.edge);
+              });
+  }
+}
+
+} // namespace kami
@@ -4,8 +4,10 @@
 #include "kami/global/arguments.hpp"
 #include "kami/math/edge.hpp"
 #include "kami/math/vertex.hpp"
+#include "kami/mesh/disjoint_set.hpp"
 #include "kami/mesh/linked_edge.hpp"
 #include <algorithm>
+#include <numeric>
 
 namespace kami {
 
@@ -13,324 +15,549 @@ namespace kami {
 // Getters
 // ==========================================================================
 
-const math::Bounds LinkedPolygon::getBounds(bool recursive,
+const math::Bounds LinkedPolygon::getBounds(const LinkedPool &pool,
+                                            bool recursive,
                                             bool stop_on_cut) const {
-  math::Bounds b;
-  for (int i = 0; i < facets.size(); i++)
-    b += facets[i].getBounds();
+  if (!recursive)
+    return pool.vertices.getBounds(first_edge, n_edges, getPartTrsf(pool));
+
+  // The faces up to the cut edges are in the part of this facet
+  const math::RigidTrsf &trsf = getPartTrsf(pool);
+  if (stop_on_cut && trsf.isAxisAligned()) {
+    updateExtent(pool);
+    math::Bounds b;
+    b += math::VertexBuffer::getBounds(extent, trsf);
+    return b;
+  }
 
-  if (recursive) {
-    for (int i = 0; i < facets.size(); i++) {
-      if ((facets[i].isOwned()) && (!stop_on_cut || !facets[i].hasCut()))
-        b += facets[i].getMesh()->getBounds(recursive, stop_on_cut);
-    }
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, stop_on_cut);
+  math::Bounds b;
+  for (uint32_t node : subtree) {
+    const LinkedPolygon &poly = pool[node];
+    b += pool.vertices.getBounds(poly.first_edge, poly.n_edges,
+                                 poly.getPartTrsf(pool));
   }
   return b;
 };
 
-const void LinkedPolygon::getBarycenter(math::Barycenter &bary, bool recursive,
-                                        bool stop_on_cut) const {
-  for (int i = 0; i < facets.size(); i++) {
-    bary.addVertex(facets[i].getFirst());
-    if (recursive && facets[i].isOwned() &&
-        (!stop_on_cut || !facets[i].hasCut()))
-      facets[i].getMesh()->getBarycenter(bary, recursive, stop_on_cut);
+void LinkedPolygon::invalidateExtent(const LinkedPool &pool) const {
+  // The ancestors of an outdated facet are already outdated
+  const LinkedPolygon *node = this;
+  while (node != nullptr && !node->extent_dirty) {
+    node->extent_dirty = true;
+    if (node->getParent(pool) == nullptr ||
+        node->getEdge(pool, node->parent_edge).hasCut())
+      break;
+    node = node->getParent(pool);
   }
-};
-
-// ==========================================================================
-// Transformations
-// ==========================================================================
-
-math::HMat LinkedPolygon::getHRotationMatrix() const {
-  math::HMat mat;
+}
 
-  // Constructing parent frame
-  math::Vec3 x_axis =
-      getEdgeDirection(parent_edge, true); // Edge direction == new X axis
-  math::Vec3 new_n = getParentNormal(); // Parent normal direction == new Z axis
-  math::Vec3 old_n = getNormal();       // Child normal direction (old Z axis)
-  math::Vec3 y_axis =
-      old_n.cross(x_axis); // Y direction is the cross product of the other two
-  y_axis.normalize();
+void LinkedPolygon::updateExtent(const LinkedPool &pool) const {
+  if (!extent_dirty)
+    return;
 
-  std::cout << "Sin: " << new_n.dot(old_n) << ", Cos: " << new_n.dot(y_axis)
-            << " => ";
+  // Outdated facets, parents first
+  std::vector<uint32_t> dirty{(uint32_t)uid};
+  for (size_t k = 0; k < dirty.size(); k++) {
+    for (const auto &edge : pool[dirty[k]].getEdges(pool)) {
+      if (edge.isOwned() && !edge.hasCut() && pool[edge.getMesh()].extent_dirty)
+        dirty.push_back(edge.getMesh());
+    }
+  }
 
-  double theta = -M_PI_2 + std::atan2(new_n.dot(old_n), new_n.dot(y_axis));
-  std::cout << 180 * theta / M_PI << "° to go" << std::endl;
+  for (size_t k = dirty.size(); k-- > 0;) {
+    const LinkedPolygon &poly = pool[dirty[k]];
+    poly.extent = pool.vertices.getExtent(poly.first_edge, poly.n_edges);
+    for (const auto &edge : poly.getEdges(pool)) {
+      if (edge.isOwned() && !edge.hasCut())
+        poly.extent += pool[edge.getMesh()].extent;
+    }
+    poly.extent_dirty = false;
+  }
+}
 
-  // Set the matrix for a rotation around X
-  mat(1, 1) = std::cos(theta);
-  mat(1, 2) = -std::sin(theta);
-  mat(2, 1) = std::sin(theta);
-  mat(2, 2) = std::cos(theta);
+void LinkedPolygon::getEdgeGeometries(const LinkedPool &pool,
+                                      math::EdgeBlock &geometries) const {
+  geometries.clear();
+  for (int i = 0; i < n_edges; i++)
+    geometries.push_back(getEdgeGeometry(pool, i));
+}
 
-  // mat.simplify();
+const void LinkedPolygon::getBarycenter(const LinkedPool &pool,
+                                        math::Barycenter &bary, bool recursive,
+                                        bool stop_on_cut) const {
+  std::vector<uint32_t> subtree{(uint32_t)uid};
+  if (recursive) {
+    subtree.resize(0);
+    getSubtree(pool, subtree, stop_on_cut);
+  }
+  for (uint32_t node : subtree) {
+    for (uint32_t i = 0; i < pool[node].n_edges; i++)
+      bary.addVertex(pool[node].getVertex(pool, i));
+  }
+};
 
-  return mat;
+void LinkedPolygon::getChildUIDs(const LinkedPool &pool,
+                                 std::vector<ulong> &uids) const {
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, true);
+  uids.insert(uids.end(), subtree.begin(), subtree.end());
 }
 
-math::HMat LinkedPolygon::getHTransform(int edge) const {
-  math::HMat mat;
+void LinkedPolygon::getSubtree(const LinkedPool &pool,
+                               std::vector<uint32_t> &subtree, bool stop_on_cut,
+                               long max_depth, TreeOrder order,
+                               std::vector<uint32_t> *sizes) const {
+  size_t start = subtree.size();
+  std::vector<long> depths;
+  std::vector<std::pair<uint32_t, long>> stack{{uid, 0}};
+  while (!stack.empty()) {
+    auto [node, depth] = stack.back();
+    stack.pop_back();
+    if (max_depth != args::NO_REC_LIMIT && depth >= max_depth)
+      continue;
+    subtree.push_back(node);
+    if (sizes != nullptr)
+      depths.push_back(depth);
+
+    // The children are pushed so that they are popped in the edge order for
+    // the preorder. The post-order is the preorder made with the children
+    // popped in the reverse edge order, then reversed.
+    auto facets = pool[node].getEdges(pool);
+    for (size_t k = 0; k < facets.size(); k++) {
+      size_t i = (order == TreeOrder::PRE_ORDER) ? facets.size() - 1 - k : k;
+      if (facets[i].isOwned() && (!stop_on_cut || !facets[i].hasCut()))
+        stack.push_back({facets[i].getMesh(), depth + 1});
+    }
+  }
 
-  // Edge direction == new X axis
-  math::Vec3 x_axis = getEdgeDirection(parent_edge, true);
-  mat.setRotXAsAxis(x_axis);
+  // A subtree ends before the next facet which is not deeper than its root.
+  // Reversing the order (for the post-order) keeps the sizes valid, the
+  // subtree of the facet i then being the range (i - sizes[i], i].
+  if (sizes != nullptr) {
+    size_t offset = sizes->size();
+    sizes->resize(offset + depths.size());
+    std::vector<size_t> open;
+    for (size_t i = 0; i < depths.size(); i++) {
+      while (!open.empty() && depths[open.back()] >= depths[i]) {
+        (*sizes)[offset + open.back()] = i - open.back();
+        open.pop_back();
+      }
+      open.push_back(i);
+    }
+    for (size_t i : open)
+      (*sizes)[offset + i] = depths.size() - i;
+    if (order == TreeOrder::POST_ORDER)
+      std::reverse(sizes->begin() + offset, sizes->end());
+  }
 
-  // Parent normal direction == new Z axis
-  math::Vec3 z_axis = getNormal();
-  z_axis.normalize();
-  mat.setRotZAsAxis(z_axis);
+  if (order == TreeOrder::POST_ORDER)
+    std::reverse(subtree.begin() + start, subtree.end());
+}
 
-  // Y direction is the cross product of the other two
-  auto y_axis = z_axis.cross(x_axis);
-  // y_axis.normalize();
-  mat.setRotYAsAxis(y_axis);
+// ==========================================================================
+// Transformations
+// ==========================================================================
 
-  // Translation part
-  mat.setTransAsAxis(getEdgePosition(parent_edge));
+math::Rigid2D LinkedPolygon::getPlacement(const LinkedPool &pool) const {
+  const LinkedPolygon *parent = getParent(pool);
+  if (parent == nullptr) {
+    math::Vertex origin = getEdgePosition(pool, parent_edge);
+    math::Vertex x_axis = getEdgeDirection(pool, parent_edge);
+    return math::Rigid2D::alongSegment(origin(0), origin(1),
+                                       origin(0) + x_axis(0),
+                                       origin(1) + x_axis(1));
+  }
 
-  return mat;
+  // The parent stores the shared edge in the other direction, unless the
+  // winding of the two facets is not consistent
+  const auto &edge = getEdges(pool)[parent_edge];
+  int k = edge.getLinkedOnChildEdge();
+  bool reversed = parent->getEdges(pool)[k].reverseOf(edge);
+  uint32_t a = parent->first_edge + k;
+  uint32_t b = parent->first_edge + ((k + 1 == parent->n_edges) ? 0 : k + 1);
+  if (!reversed)
+    std::swap(a, b);
+  return math::Rigid2D::alongSegment(pool.vertices.x[b], pool.vertices.y[b],
+                                     pool.vertices.x[a], pool.vertices.y[a]);
 }
 
-void LinkedPolygon::transform(const math::HMat &mat, bool recusive,
-                              bool stop_on_cut) {
-
-  // Transform facets
-  for (int i = 0; i < facets.size(); i++)
-    facets[i].transformEdge(mat);
-
-  // Transmit the transformation to the children
-  if (recusive) {
-    for (int i = 0; i < facets.size(); i++) {
-      if (facets[i].isOwned() && (!stop_on_cut || !facets[i].hasCut()))
-        facets[i].getMesh()->transform(mat, recusive, stop_on_cut);
-    }
+void LinkedPolygon::transform(LinkedPool &pool, const math::RigidTrsf &trsf,
+                              bool recusive, bool stop_on_cut) {
+  // The buffer holds the positions before the transformation of the part
+  if (!recusive) {
+    const math::RigidTrsf &part_trsf = getPartTrsf(pool);
+    pool.vertices.transform(part_trsf.inverse() * trsf * part_trsf,
+                            first_edge, n_edges);
+    invalidateExtent(pool);
+    return;
   }
-}
 
-void LinkedPolygon::unfoldMesh(long depth, long max_depth) {
-  // If max depth, stop
-  if (max_depth != args::NO_REC_LIMIT && depth >= max_depth)
+  if (!isPartRoot())
+    makePart(pool);
+  pending = trsf * pending;
+  if (stop_on_cut)
     return;
 
-  std::cout << "Face " << uid;
+  // Transmit the transformation to the parts behind the cut edges
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, false);
+  for (uint32_t node : subtree) {
+    if (node != uid && pool[node].isPartRoot())
+      pool[node].pending = trsf * pool[node].pending;
+  }
+}
 
-  // Get the cumulated transformation
-  auto rot_mat = getHRotationMatrix();
-  auto trsf_mat = getHTransform(parent_edge);
-  // auto inv_trsf_mat = trsf_mat.invert();
-  auto inv_trsf_mat = trsf_mat.inverse();
+void LinkedPolygon::makePart(LinkedPool &pool) {
+  pending = getPartTrsf(pool);
 
-  unfold_coef =
-      (math::Mat4)(getParentTrsf() * trsf_mat * rot_mat * inv_trsf_mat);
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, true);
+  for (uint32_t node : subtree)
+    pool[node].part = uid;
+}
 
-  /*std::cout << getParentTrsf() << std::endl;
-  std::cout << trsf_mat << std::endl;*/
-  std::cout << rot_mat << std::endl;
-  /*std::cout << inv_trsf_mat << std::endl;
-  std::cout << unfold_coef << std::endl;*/
+void LinkedPolygon::unfoldMesh(LinkedPool &pool, long depth, long max_depth,
+                               TaskPool *tasks) {
+  // Parents are unfolded before their children, which are placed on them
+  invalidateExtent(pool);
+  std::vector<uint32_t> subtree, sizes;
+  getSubtree(pool, subtree, false,
+             (max_depth == args::NO_REC_LIMIT) ? max_depth : max_depth - depth,
+             TreeOrder::PRE_ORDER, (tasks != nullptr) ? &sizes : nullptr);
+  if (tasks == nullptr || subtree.size() < UNFOLD_GRAIN) {
+    for (uint32_t node : subtree)
+      pool[node].unfoldFacet(pool);
+    return;
+  }
 
-  // Rotate this face and normal
-  transform(unfold_coef, false, false);
+  // Each facet only reads the vertices of its parent, which is unfolded before
+  // its children are submitted, so the subtrees are independent. The last
+  // large child is kept by the current task, so that a chain of facets does
+  // not spawn one task per facet.
+  std::function<void(size_t)> unfold_subtree = [&](size_t i) {
+    while (true) {
+      pool[subtree[i]].unfoldFacet(pool);
+      size_t next = 0;
+      for (size_t c = i + 1; c < i + sizes[i]; c += sizes[c]) {
+        if (sizes[c] < UNFOLD_GRAIN) {
+          for (size_t k = c; k < c + sizes[c]; k++)
+            pool[subtree[k]].unfoldFacet(pool);
+          continue;
+        }
+        if (next != 0)
+          tasks->submit([&unfold_subtree, next] { unfold_subtree(next); });
+        next = c;
+      }
+      if (next == 0)
+        return;
+      i = next;
+    }
+  };
+  tasks->run([&unfold_subtree] { unfold_subtree(0); });
+}
 
-  // Rotate children
-  for (int i = 0; i < facets.size(); i++) {
-    if (facets[i].isOwned())
-      facets[i].getMesh()->unfoldMesh(depth + 1, max_depth);
-  }
+void LinkedPolygon::unfoldFacet(LinkedPool &pool) {
+  // Frame of the facet, X along the parent edge
+  math::Vec3 origin = getEdgePosition(pool, parent_edge);
+  math::Vec3 x_axis = getEdgeDirection(pool, parent_edge);
+  x_axis.normalize();
+  math::Vec3 z_axis = getNormal();
+  math::Vec3 y_axis = z_axis.cross(x_axis);
+  y_axis.normalize();
 
-  // Change Normal
-  math::Vec4 result = (math::Vec4)(unfold_coef * n);
-  n = math::Vertex(result(0), result(1), result(2), 0);
-  n.simplify();
-  n.normalize();
-  std::cout << "Face " << uid;
-  getHRotationMatrix();
+  // Place this face, which now looks toward the Z axis
+  unfold_coef = getPlacement(pool);
+  pool.vertices.unfold(origin, x_axis, y_axis, unfold_coef, first_edge,
+                       n_edges);
+  n = math::Vertex(0, 0, 1, 0);
+  extent_dirty = true;
 }
 
 // ==========================================================================
 // Linking logic
 // ==========================================================================
 
-void LinkedPolygon::mergeSimilar(LinkedPool &pool,
-                                 std::vector<ulong> &removed) {
-  std::vector<math::VertexPair> new_facets;
-  new_facets.resize(0);
-
-  // Construct from this edge
-  for (auto &f : facets)
-    new_facets.push_back(math::VertexPair{f.getFirst(), f.getSecond()});
+/**
+ * @brief Edge of a region that does not cancel with another edge of it
+ */
+struct BoundaryEdge {
+  math::VertexId from, to;
+  uint32_t edge; //< Index of the edge in the arena
+};
 
-  // Iterate over the other to check for faces that are adjacents and have the
-  // same dir
-  for (auto &poly : pool) {
-    // Prevent for self computation
-    if (poly->uid == uid) {
-      continue;
+/**
+ * @brief Trace the boundary of a region of facets as a single loop.
+ *
+ * @param pool the pool of facets
+ * @param graph the adjacency of the pool
+ * @param roots the region of each facet
+ * @param first the first facet of the region
+ * @param last past the last facet of the region
+ * @param loop the arena indices of the edges of the loop, in order
+ * @return false if the boundary is not a single simple loop
+ */
+static bool traceBoundary(const PolygonArena<LinkedPolygon> &pool,
+                          const DualGraph &graph,
+                          const std::vector<uint32_t> &roots,
+                          const uint32_t *first, const uint32_t *last,
+                          std::vector<uint32_t> &loop) {
+  // Keep the edges without a reversed twin in the region
+  std::vector<BoundaryEdge> boundary;
+  std::vector<bool> inner;
+  for (const uint32_t *face = first; face != last; face++) {
+    auto edges = pool[*face].getEdges(pool);
+    inner.assign(edges.size(), false);
+    for (auto link = graph.begin(*face); link != graph.end(*face); link++) {
+      if (roots[link->face] == roots[*face] &&
+          edges[link->edge].reverseOf(
+              pool[link->face].getEdges(pool)[link->other_edge]))
+        inner[link->edge] = true;
     }
-
-    // If same normal, check for proximity
-    if (math::Edge::colinear(n, poly->n)) {
-      bool done = false;
-      for (ulong oth_idx = 0; !done && oth_idx < poly->facets.size();
-           oth_idx++) {
-        if (auto it = std::find_if(new_facets.begin(), new_facets.end(),
-                                   [&poly, &oth_idx](math::VertexPair &pair) {
-                                     return poly->facets[oth_idx].sameAs(pair);
-                                   });
-            it != new_facets.end()) {
-          new_facets.erase(it);
-          for (ulong i = 0; i < poly->facets.size(); i++) {
-            if (i != oth_idx)
-              new_facets.insert(it++,
-                                math::VertexPair{poly->facets[i].getFirst(),
-                                                 poly->facets[i].getSecond()});
-          }
-          done = true;
-        }
-      }
-
-      if (done) {
-        removed.push_back(poly->uid);
-      }
+    for (uint32_t e = 0; e < edges.size(); e++) {
+      if (!inner[e])
+        boundary.push_back(BoundaryEdge{edges[e].getFirstId(),
+                                        edges[e].getSecondId(),
+                                        uint32_t(edges.begin() + e -
+                                                 pool.edges.data())});
     }
   }
-
-  // Update facets with the new edges
-  facets.resize(0);
-  for (auto &p : new_facets) {
-    if (auto it = std::find_if(new_facets.begin(), new_facets.end(),
-                               [&p](math::VertexPair &other) {
-                                 return p.first.sameAs(other.second) &&
-                                        p.second.sameAs(other.first);
-                               });
-        it == new_facets.end()) {
-      facets.push_back([&p]() {
-        LinkedEdge<LinkedPolygon> edge(p);
-        return edge;
-      }());
-    }
+  if (boundary.size() < 3)
+    return false;
+
+  // Index the edges by starting vertex, which must be unique in a simple loop
+  std::vector<uint32_t> by_start(boundary.size());
+  std::iota(by_start.begin(), by_start.end(), 0);
+  std::sort(by_start.begin(), by_start.end(), [&](uint32_t a, uint32_t b) {
+    return boundary[a].from < boundary[b].from;
+  });
+  for (size_t i = 1; i < by_start.size(); i++) {
+    if (boundary[by_start[i]].from == boundary[by_start[i - 1]].from)
+      return false;
   }
+
+  // Follow the loop from the first edge
+  loop.resize(0);
+  uint32_t current = 0;
+  do {
+    loop.push_back(boundary[current].edge);
+    auto next = std::lower_bound(
+        by_start.begin(), by_start.end(), boundary[current].to,
+        [&](uint32_t a, math::VertexId v) { return boundary[a].from < v; });
+    if (next == by_start.end() || boundary[*next].from != boundary[current].to)
+      return false;
+    current = *next;
+  } while (current != 0 && loop.size() < boundary.size());
+
+  return current == 0 && loop.size() == boundary.size();
 }
 
-std::vector<ulong> LinkedPolygon::linkNeighbours(LinkedPool &pool) {
-  unsigned int done = 0;
-  unsigned int max = 0;
-  for (int i = 0; i < facets.size(); i++) {
-    done |= ((facets[i].nullMesh()) ? 0 : (int)(std::pow(2, i)));
-    max |= (unsigned int)std::pow(2, i);
+void LinkedPolygon::mergeSimilar(LinkedPool &pool, const DualGraph &graph) {
+  // Join the facets of same direction that share an edge
+  DisjointSet regions(pool.size());
+  for (uint32_t f = 0; f < pool.size(); f++) {
+    for (auto link = graph.begin(f); link != graph.end(f); link++) {
+      const auto &other = pool[link->face];
+      if (link->face > f && math::Edge::sameDir(pool[f].n, other.n) &&
+          pool[f].getEdges(pool)[link->edge].reverseOf(
+              other.getEdges(pool)[link->other_edge]))
+        regions.unite(f, link->face);
+    }
   }
 
-  std::vector<ulong> created(0);
-  for (ulong i = 0; i < pool.size(); i++) {
-    if (uid == pool[i]->uid)
+  // Group the facets by region, in the pool order
+  std::vector<uint32_t> roots(pool.size());
+  std::vector<uint32_t> offsets(pool.size() + 1, 0);
+  for (uint32_t f = 0; f < pool.size(); f++) {
+    roots[f] = regions.find(f);
+    offsets[roots[f] + 1]++;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<uint32_t> members(pool.size());
+  std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (uint32_t f = 0; f < pool.size(); f++)
+    members[cursor[roots[f]]++] = f;
+
+  // Make one polygon per region, starting where its first facet was
+  LinkedPool merged;
+  merged.polygons.reserve(pool.size());
+  merged.edges.reserve(pool.edges.size());
+  merged.vertices.reserve(pool.edges.size());
+  auto push = [&](const LinkedPolygon &face, const uint32_t *edges, size_t n) {
+    LinkedPolygon &poly = merged.polygons.emplace_back(face);
+    poly.uid = merged.polygons.size() - 1;
+    poly.first_edge = merged.edges.size();
+    poly.n_edges = n;
+    for (size_t i = 0; i < n; i++) {
+      merged.edges.push_back(pool.edges[edges[i]]);
+      merged.vertices.push_back(pool.vertices.get(edges[i]));
+    }
+  };
+  std::vector<uint32_t> loop;
+  for (uint32_t f = 0; f < pool.size(); f++) {
+    const uint32_t *first = members.data() + offsets[roots[f]];
+    const uint32_t *last = members.data() + offsets[roots[f] + 1];
+    if (*first != f)
       continue;
 
-    bool unlinked_facet = (pool[i]->parent_edge == INT8_MAX);
-    for (int f = 0; f < facets.size(); f++) {
-      int on_edge = 0;
-      if (facets[f].nullMesh() && pool[i]->hasSameEdge(this, f, on_edge)) {
-        facets[f].linkEdgeAsOwner(pool[i].get(), unlinked_facet);
-        facets[f].setLinkedOnChildEdge(on_edge);
-        if (unlinked_facet)
-          created.push_back(i);
-        done |= (unsigned int)std::pow(2, f);
-        break;
+    if (last - first > 1 &&
+        traceBoundary(pool, graph, roots, first, last, loop)) {
+      push(pool[f], loop.data(), loop.size());
+    } else {
+      for (const uint32_t *face = first; face != last; face++) {
+        loop.resize(pool[*face].n_edges);
+        std::iota(loop.begin(), loop.end(), pool[*face].first_edge);
+        push(pool[*face], loop.data(), loop.size());
       }
     }
+  }
+  pool = std::move(merged);
+}
 
-    if (done == max)
-      break;
+std::vector<ulong> LinkedPolygon::linkNeighbours(LinkedPool &pool,
+                                                 const DualGraph &graph,
+                                                 uint32_t index) {
+  auto facets = getEdges(pool);
+  std::vector<ulong> created(0);
+  for (auto link = graph.begin(index); link != graph.end(index); link++) {
+    if (link->face == index || !facets[link->edge].nullMesh())
+      continue;
+
+    auto &neighbour = pool[link->face];
+    bool unlinked_facet = (neighbour.parent_edge == INT8_MAX);
+    facets[link->edge].linkEdgeAsOwner(link->face, unlinked_facet);
+    facets[link->edge].setLinkedOnChildEdge(link->other_edge);
+    neighbour.linkToNeighbour(pool, index, link->edge, link->other_edge);
+    if (unlinked_facet)
+      created.push_back(link->face);
   }
 
   return created;
 }
 
-bool LinkedPolygon::hasSameEdge(LinkedPolygon *parent_facet, int edge,
-                                int &on_edge) {
-  // Get the vertex we want to find
-  auto pair = parent_facet->getEdgeVertex(edge);
-
-  for (int i = 0; i < facets.size(); i++) {
-    if (facets[i].sameAs(pair)) {
-      facets[i].setMesh(parent_facet);
-      facets[i].setLinkedOnChildEdge(edge);
-      on_edge = i;
-      if (parent_edge == INT8_MAX) {
-        facets[i].setLineStyle(LineStyle::INNER);
-        parent_edge = (parent_edge == INT8_MAX) ? i : parent_edge;
-      }
-      return true;
-    }
+void LinkedPolygon::linkToNeighbour(LinkedPool &pool, uint32_t parent_facet,
+                                    int edge, int on_edge) {
+  auto facets = getEdges(pool);
+  facets[on_edge].setMesh(parent_facet);
+  facets[on_edge].setLinkedOnChildEdge(edge);
+  if (parent_edge == INT8_MAX) {
+    facets[on_edge].setLineStyle(LineStyle::INNER);
+    parent_edge = on_edge;
   }
-
-  return false;
 }
 
 // ==========================================================================
 // Sclicing logic
 // ==========================================================================
 
-void LinkedPolygon::sliceEdge(int edge) {
+void LinkedPolygon::sliceEdge(LinkedPool &pool, int edge) {
+  auto facets = getEdges(pool);
+  auto &child = pool[facets[edge].getMesh()];
+
   // Cut the edge on this side
   facets[edge].setCutted(true);
-  facets[edge].getMesh()->cutOnParentEdge(facets[edge].getCutNumber());
+  child.cutOnParentEdge(pool, facets[edge].getCutNumber());
+  invalidateExtent(pool);
 
   // Move the child to the center
-  auto b = facets[edge].getMesh()->getBounds(true, true);
-  math::HMat mat;
-  mat.setTransAsAxis(math::Vec3{-b.xmin, -b.ymin, 0});
-  facets[edge].getMesh()->transform(mat, true, true);
+  auto b = child.getBounds(pool, true, true);
+  child.transform(pool,
+                  math::RigidTrsf::translation(math::Vec3{-b.xmin, -b.ymin, 0}),
+                  true, true);
 }
 
-void LinkedPolygon::cutOnParentEdge(int cut_number) {
-  facets[parent_edge].setCutted(true, cut_number);
+void LinkedPolygon::cutOnParentEdge(LinkedPool &pool, int cut_number) {
+  getEdges(pool)[parent_edge].setCutted(true, cut_number);
 }
 
-overlaps::MeshOverlaps LinkedPolygon::hasOverlaps(const LinkedPool &pool) {
-  overlaps::MeshOverlaps out;
-
-  for (const auto &mesh : pool) {
-    // If same mesh, skip
-    if (mesh->uid == uid)
-      continue;
+void LinkedPolygon::sliceFromParent(LinkedPool &pool) {
+  LinkedPolygon &parent = pool[getEdge(pool, parent_edge).getMesh()];
+  auto facets = parent.getEdges(pool);
+  for (int i = 0; i < facets.size(); i++) {
+    if (facets[i].isOwned() && facets[i].getMesh() == uid) {
+      parent.sliceEdge(pool, i);
+      return;
+    }
+  }
+}
 
-    bool found = false;
-    for (int th = 0; th < facets.size(); th++) {
-      for (int oth = 0; oth < mesh->facets.size(); oth++) {
-        auto params = LinkedEdge<LinkedPolygon>::findIntersect(
-            facets[th], mesh->facets[oth]);
-
-        if ((params.t >= math::Edge::VERTEX_AREA) &&
-            (params.t <= 1 - math::Edge::VERTEX_AREA) &&
-            (params.s >= math::Edge::VERTEX_AREA) &&
-            (params.s <= 1 - math::Edge::VERTEX_AREA)) {
-          found = true;
-          out.push_back(overlaps::Overlap{uid, mesh->uid});
-          break;
-        }
+overlaps::MeshOverlaps
+LinkedPolygon::sliceChildren(LinkedPool &pool,
+                             std::vector<packing::Box<LinkedPolygon>> &boxes,
+                             TaskPool *tasks) {
+  // Every facet is sliced after its children, in the order of a recursion
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, false, args::NO_REC_LIMIT, TreeOrder::POST_ORDER);
+  OverlapGraph graph(pool, uid, tasks);
+
+  // Stack of the overlaps returned by the facets not consumed by their parent.
+  // The lists are recycled from a facet to the next one.
+  overlaps::OverlapsPool storage;
+  std::vector<overlaps::MeshOverlaps> returned;
+  std::vector<overlaps::MeshOverlaps> overlaps;
+  for (uint32_t node : subtree) {
+    auto facets = pool[node].getEdges(pool);
+
+    // The children were pushed in the edge order
+    overlaps.resize(0);
+    for (size_t i = 0; i <= facets.size(); i++)
+      overlaps.push_back(storage.acquire());
+    for (size_t i = facets.size(); i-- > 0;) {
+      if (facets[i].isOwned()) {
+        std::swap(overlaps[i], returned.back());
+        storage.release(std::move(returned.back()));
+        returned.pop_back();
       }
-      if (found)
-        break;
     }
+    pool[node].sliceFacet(pool, boxes, overlaps, graph);
+
+    returned.push_back(std::move(overlaps[0]));
+    for (size_t i = 1; i < overlaps.size(); i++)
+      storage.release(std::move(overlaps[i]));
   }
 
-  return out;
+  return std::move(returned.back());
 }
 
-overlaps::MeshOverlaps
-LinkedPolygon::sliceChildren(const LinkedPool &pool,
-                             std::vector<packing::Box<LinkedPolygon>> &boxes) {
-  // Populate overlaps
-  std::vector<overlaps::MeshOverlaps> overlaps(facets.size() + 1);
-  for (int i = 0; i < facets.size(); i++) {
-    overlaps[i] = (facets[i].isOwned() && !facets[i].nullMesh())
-                      ? facets[i].getMesh()->sliceChildren(pool, boxes)
-                      : overlaps::MeshOverlaps();
+void LinkedPolygon::sliceMinCut(
+    LinkedPool &pool, std::vector<packing::Box<LinkedPolygon>> &boxes,
+    TaskPool *tasks) {
+  // All the overlaps of the unfold, before any part moves
+  overlaps::MeshOverlaps pairs;
+  {
+    OverlapGraph graph(pool, uid, tasks);
+    for (uint32_t face = 0; face < pool.size(); face++)
+      graph.read(face, pairs);
   }
-  overlaps[facets.size()] = hasOverlaps(pool);
+  TreeMulticut multicut(pool, uid, pairs);
+  std::cout << "\tCutting " << multicut.getCutCount() << " edges for "
+            << pairs.size() << " overlaps (" << multicut.getGroupCount()
+            << " groups, " << multicut.getExactGroupCount()
+            << " solved exactly, " << multicut.getExactWindowCount()
+            << " windows solved exactly saving " << multicut.getSavedCutCount()
+            << " cuts)" << std::endl;
+
+  // Children first, so that a part only moves its own facets
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, false, args::NO_REC_LIMIT, TreeOrder::POST_ORDER);
+  for (uint32_t node : subtree) {
+    if (!multicut.isCut(node))
+      continue;
+    pool[node].sliceFromParent(pool);
+    boxes.push_back(packing::Box<LinkedPolygon>{
+        &pool[node],
+        pool[node].getBounds(pool, true, true),
+    });
+  }
+}
+
+void LinkedPolygon::sliceFacet(LinkedPool &pool,
+                               std::vector<packing::Box<LinkedPolygon>> &boxes,
+                               std::vector<overlaps::MeshOverlaps> &overlaps,
+                               OverlapGraph &graph) {
+  auto facets = getEdges(pool);
+  graph.read(uid, overlaps[facets.size()]);
 
   // TODO: Remove, it's debug
   std::cout << "\tOverlaps for " << uid << std::endl;
@@ -344,79 +571,87 @@ LinkedPolygon::sliceChildren(const LinkedPool &pool,
   // Check the edges against the others
   for (int i = 0; i < facets.size(); i++) {
 
-    // Compute the intersection of the overlapping vector
-    overlaps::MeshOverlaps intersection;
-    for (int j = i + 1; j <= facets.size(); j++) {
-      intersection = intersection + overlaps[i] / overlaps[j];
-    }
+    // Cut the edge if its overlaps meet the ones of a next edge or of this
+    // facet
+    bool shared = false;
+    for (int j = i + 1; j <= facets.size() && !shared; j++)
+      shared = overlaps[i].meets(overlaps[j]);
 
-    // If the intersection is not null, cut it
-    if (intersection.size() > 0) {
-      sliceEdge(i);
+    if (shared) {
+      sliceEdge(pool, i);
+      graph.update(pool, facets[i].getMesh());
+      auto &child = pool[facets[i].getMesh()];
       boxes.push_back(packing::Box<LinkedPolygon>{
-          facets[i].getMesh(),
-          facets[i].getMesh()->getBounds(true, true),
+          &child,
+          child.getBounds(pool, true, true),
       });
-      for (int k = 0; k < facets.size(); k++) {
-        overlaps[k] = overlaps[k] - overlaps[i];
-      }
+
+      // The edges before this one drop its overlaps, the next ones keep them
+      for (int k = 0; k < i; k++)
+        overlaps[k] -= overlaps[i];
+      overlaps[i].clear();
     }
   }
 
   // Recontruct the new overlapping vector (sum of all the overlapings without
   // the ones processed by this node)
-  overlaps::MeshOverlaps new_overlaps;
-  for (int i = 0; i <= facets.size(); i++) {
-    new_overlaps = new_overlaps + overlaps[i];
-  }
-
-  return new_overlaps;
+  for (int i = 1; i <= facets.size(); i++)
+    overlaps[0] += overlaps[i];
 }
 
 // ==========================================================================
 // STL Model Unfold + SVG Export
 // ==========================================================================
 
-void LinkedPolygon::fillSVGString(std::stringstream &stream,
-                                  const math::HMat &mat,
+void LinkedPolygon::fillSVGString(LinkedPool &pool, std::stringstream &stream,
+                                  const math::RigidTrsf &mat,
                                   const std::string &color, int depth,
                                   int max_depth) {
-  if (max_depth != -1 && depth >= max_depth)
-    return;
+  std::vector<uint32_t> subtree;
+  getSubtree(pool, subtree, true,
+             (max_depth == args::NO_REC_LIMIT) ? max_depth : max_depth - depth);
 
-  transform(mat, false, true);
-
-  // Draw this facet
+  // The pending transformation of the part is applied with the export one,
+  // the vertex buffer is left untouched
+  std::vector<math::Vertex> points;
   std::vector<double> x, y;
-  for (int i = 0; i < facets.size(); i++) {
-    facets[i].setTextRatio(mat(2, 2));
-    facets[i].getAsSVGLine(stream);
-
-    x.push_back(facets[i].getFirst()(0));
-    y.push_back(facets[i].getFirst()(1));
-  }
-  svg::polyline(stream, x, y, LineStyle::NONE, color);
-
-  // Call the children
-  for (int i = 0; i < facets.size(); i++) {
-    if (facets[i].isOwned() && !facets[i].hasCut()) {
-      facets[i].getMesh()->fillSVGString(stream, mat, color, depth + 1,
-                                         max_depth);
+  for (uint32_t node : subtree) {
+    LinkedPolygon &poly = pool[node];
+    auto facets = poly.getEdges(pool);
+    math::RigidTrsf trsf = mat * poly.getPartTrsf(pool);
+
+    // Draw this facet
+    points.clear();
+    x.resize(0);
+    y.resize(0);
+    for (int i = 0; i < facets.size(); i++) {
+      points.push_back(pool.vertices.get(poly.first_edge + i, trsf));
+      x.push_back(points.back()(0));
+      y.push_back(points.back()(1));
+    }
+    for (int i = 0; i < facets.size(); i++) {
+      facets[i].setTextRatio(mat.s);
+      facets[i].getAsSVGLine(
+          stream,
+          math::Edge(points[i], points[(i + 1 == facets.size()) ? 0 : i + 1]));
     }
+    svg::polyline(stream, x, y, LineStyle::NONE, color);
   }
 };
 
-void LinkedPolygon::fillSVGProjectString(std::stringstream &stream,
-                                         const math::HMat &mat,
+void LinkedPolygon::fillSVGProjectString(LinkedPool &pool,
+                                         std::stringstream &stream,
+                                         const math::RigidTrsf &mat,
                                          const math::Vec3 &ax1,
                                          const math::Vec3 &ax2,
                                          const std::string &color) {
-  transform(mat, false, true);
+  auto facets = getEdges(pool);
+  transform(pool, mat, false, true);
 
   // Get the points
   std::vector<double> x1, x2;
   for (int i = 0; i < facets.size(); i++) {
-    math::Vec3 v1 = facets[i].getFirst();
+    math::Vec3 v1 = getVertex(pool, i);
     x1.push_back(ax1.dot(v1));
     x2.push_back(ax2.dot(v1));
   }
@@ -4,9 +4,11 @@
 #include "kami/global/logging.hpp"
 #include "kami/math/barycenter.hpp"
 #include "kami/math/bounds.hpp"
-#include "kami/math/hmat.hpp"
+#include "kami/math/rigid_trsf.hpp"
 #include "kami/mesh/linked_implementations.hpp"
 #include "kami/mesh/linked_poly.hpp"
+#include "kami/mesh/welding.hpp"
+#include "kami/packing/max_rects.hpp"
 #include <algorithm>
 #include <cmath>
 #include <memory>
@@ -20,10 +22,20 @@ namespace kami {
 // Constructor
 // ==========================================================================
 
-LinkedMeshPool::LinkedMeshPool(microstl::Mesh &mesh)
-    : std::vector<std::shared_ptr<LinkedPolygon>>(mesh.facets.size()) {
-  for (ulong i = 0; i < mesh.facets.size(); i++) {
-    (*this)[i] = std::make_shared<LinkedTriangle>(&mesh.facets[i], i);
+LinkedMeshPool::LinkedMeshPool(const io::StlMesh &mesh) {
+  WeldedMesh welded;
+  TIMED_UTILS;
+  TIMED_SECTION("Welding vertices", {
+    welded = weldVertices(mesh);
+    std::cout << "\tFound " << welded.vertices.size() << " unique vertices"
+              << std::endl;
+  });
+
+  polygons.reserve(welded.size());
+  edges.reserve(3 * welded.size());
+  vertices.reserve(3 * welded.size());
+  for (ulong i = 0; i < welded.size(); i++) {
+    polygons.push_back(LinkedTriangle(*this, welded, i));
   }
   this->makeFacetPoolInternalLink();
 }
@@ -37,44 +49,33 @@ void LinkedMeshPool::makeFacetPoolInternalLink() {
   TIMED_SECTION("Mesh preparation", {
     // Merging facets of same normal
     printStepHeader("Merging facets of same direction");
-    std::vector<ulong> removed(0);
-    for (auto &poly : *this) {
-      if (auto it = std::find_if(
-              removed.begin(), removed.end(),
-              [&poly](ulong &other) { return other == poly->getUID(); });
-          it == removed.end()) {
-        poly->mergeSimilar(*this, removed);
-      }
-    }
-
-    // Remove all faces that have been merged from the pool
-    printStepHeader("Removing merged faces");
-    for (const auto &uid : removed) {
-      if (auto it = std::find_if(this->begin(), this->end(),
-                                 [&uid](std::shared_ptr<LinkedPolygon> &poly) {
-                                   return poly->getUID() == uid;
-                                 });
-          it != this->end()) {
-        this->erase(it);
-      }
-    }
+    ulong n_triangles = this->size();
+    LinkedPolygon::mergeSimilar(*this, DualGraph(*this));
+    std::cout << "\tMerged " << n_triangles << " triangles into "
+              << this->size() << " faces" << std::endl;
 
     // Backuping everything
-    for (auto &f : *this) {
-      _unfold_unlinked.push_back(*f.get());
-    }
+    _unfold_unlinked = *this;
+
+    // Building the adjacency between the faces
+    printStepHeader("Building faces adjacency");
+    DualGraph graph(*this);
 
     // Linking every facet
     printStepHeader("Mesh Linking");
     ulong index = 0;
     std::vector<ulong> stack{0};
     while ((index < stack.size()) && (index < this->size())) {
-      auto created = (*this)[stack[index]]->linkNeighbours(*this);
+      auto created =
+          (*this)[stack[index]].linkNeighbours(*this, graph, stack[index]);
       stack.insert(stack.end(), created.begin(), created.end());
       index++;
     }
 
-    _unfolded_bounds += (*this)[root]->getBounds(true);
+    // The linked mesh is a single part until it is sliced
+    (*this)[root].makePart(*this);
+
+    _unfolded_bounds += (*this)[root].getBounds(*this, true);
   })
 }
 
@@ -82,22 +83,31 @@ void LinkedMeshPool::makeFacetPoolInternalLink() {
 // Slicing
 // ==========================================================================
 
-MeshBinVector LinkedMeshPool::slice() {
+MeshBinVector LinkedMeshPool::slice(int n_threads, args::SlicingMode mode,
+                                    args::PackingEngine engine) {
   MeshBoxVector boxes;
 
   TIMED_UTILS;
   TIMED_SECTION("Mesh slicing", {
-    (*this)[root]->sliceChildren(*this, boxes);
+    std::unique_ptr<TaskPool> tasks;
+    if (n_threads > 1)
+      tasks = std::make_unique<TaskPool>(n_threads);
+    if (mode == args::SlicingMode::MIN_CUT)
+      (*this)[root].sliceMinCut(*this, boxes, tasks.get());
+    else
+      (*this)[root].sliceChildren(*this, boxes, tasks.get());
 
     // Transforming the root
-    auto b = (*this)[root]->getBounds(true, true);
-    math::HMat mat;
-    mat.setTransAsAxis(math::Vec3{-b.xmin, -b.ymin, 0});
-    (*this)[root]->transform(mat, true, true);
+    auto b = (*this)[root].getBounds(*this, true, true);
+    (*this)[root].transform(
+        *this, math::RigidTrsf::translation(math::Vec3{-b.xmin, -b.ymin, 0}),
+        true, true);
 
     // Adding the root to the list
     boxes.push_back(
-        MeshBox((*this)[root].get(), (*this)[root]->getBounds(true)));
+        MeshBox(&(*this)[root], (*this)[root].getBounds(*this, true)));
+
+    splitOversized(boxes);
 
     printStepHeader("Slicing result");
     std::cout << "Got " << boxes.size() << " parts for this mesh" << std::endl;
@@ -110,10 +120,57 @@ MeshBinVector LinkedMeshPool::slice() {
 
   // Launch the bin packing
   MeshBinVector bins;
-  TIMED_SECTION("Paper box packing", bins = binPackingAlgorithm(boxes));
+  TIMED_SECTION("Paper box packing", {
+    if (engine == args::PackingEngine::MAX_RECTS)
+      bins = maxRectsAlgorithm(boxes);
+    else
+      bins = binPackingAlgorithm(boxes);
+  });
   return bins;
 }
 
+void LinkedMeshPool::splitOversized(MeshBoxVector &boxes) {
+  std::vector<uint32_t> part, sizes;
+  ulong n_splits = 0;
+
+  // The pieces are appended, and checked in turn
+  for (size_t k = 0; k < boxes.size(); k++) {
+    while (!fitsFormat(boxes[k])) {
+      LinkedPolygon &part_root = *boxes[k].root;
+      part.resize(0);
+      sizes.resize(0);
+      part_root.getSubtree(*this, part, true, args::NO_REC_LIMIT,
+                           LinkedPolygon::TreeOrder::PRE_ORDER, &sizes);
+      if (part.size() < 2) {
+        std::cout << "\tFacet " << part_root.getUID()
+                  << " alone does not fit in the bin format" << std::endl;
+        break;
+      }
+
+      // The subtree closest to half of the part
+      size_t best = 1;
+      for (size_t i = 2; i < part.size(); i++) {
+        if (std::abs(2 * (long)sizes[i] - (long)part.size()) <
+            std::abs(2 * (long)sizes[best] - (long)part.size()))
+          best = i;
+      }
+      LinkedPolygon &piece = (*this)[part[best]];
+      piece.sliceFromParent(*this);
+      boxes.push_back(MeshBox(&piece, piece.getBounds(*this, true, true)));
+
+      // The rest of the part back to the origin
+      auto b = part_root.getBounds(*this, true, true);
+      part_root.transform(
+          *this, math::RigidTrsf::translation(math::Vec3{-b.xmin, -b.ymin, 0}),
+          true, true);
+      boxes[k] = MeshBox(&part_root, part_root.getBounds(*this, true, true));
+      n_splits++;
+    }
+  }
+  std::cout << "\tSplit " << n_splits << " times the parts too big for the "
+            << format << " format" << std::endl;
+}
+
 MeshBinVector LinkedMeshPool::binPackingAlgorithm(MeshBoxVector &boxes) {
   // Sorting the items by decreasing value
   std::sort(boxes.begin(), boxes.end(), [](MeshBox &elem1, MeshBox &elem2) {
@@ -150,29 +207,30 @@ MeshBinVector LinkedMeshPool::binPackingAlgorithm(MeshBoxVector &boxes) {
 
     // Compute best position
     ulong best_bin = 0;
-    ulong best_corner = 0;
+    packing::Corner best_corner;
     ulong best_rotated = false;
     for (ulong n_bin = 0; n_bin < bins.size(); n_bin++) {
       std::cout << "\tBin " << n_bin + 1 << " corners :" << std::endl;
-      for (ulong n_c = 0; n_c < bins[n_bin].corners.size(); n_c++) {
-        std::cout << "\t\t" << n_c << " -> " << bins[n_bin].corners[n_c];
+      ulong n_c = 0;
+      for (const packing::Corner &corner : bins[n_bin].corners) {
+        std::cout << "\t\t" << n_c++ << " -> " << corner;
 
         // Test without rotation
-        temp_score = bins[n_bin].getScore(n_c, box, box.rotated);
+        temp_score = bins[n_bin].getScore(corner, box, box.rotated);
         std::cout << " NR(" << temp_score << ") ";
         if (temp_score > score) {
           best_bin = n_bin;
-          best_corner = n_c;
+          best_corner = corner;
           score = temp_score;
           best_rotated = box.rotated;
         }
 
         // Test with rotation
-        temp_score = bins[n_bin].getScore(n_c, box, !box.rotated);
+        temp_score = bins[n_bin].getScore(corner, box, !box.rotated);
         std::cout << "R(" << temp_score << ") " << std::endl;
         if (temp_score > score) {
           best_bin = n_bin;
-          best_corner = n_c;
+          best_corner = corner;
           score = temp_score;
           best_rotated = !box.rotated;
         }
@@ -190,13 +248,56 @@ MeshBinVector LinkedMeshPool::binPackingAlgorithm(MeshBoxVector &boxes) {
                 << ((best_rotated) ? " [Rotated]" : " [Not Rotated]")
                 << " with score " << score << std::endl;
       bins.push_back(packing::Bin<LinkedPolygon>(format));
-      bins[bins.size() - 1].putIn(0, box, false);
+      bins[bins.size() - 1].putIn(packing::Corner(), box, false);
     }
     std::cout << std::endl;
   }
   return bins;
 }
 
+MeshBinVector LinkedMeshPool::maxRectsAlgorithm(MeshBoxVector &boxes) {
+  // Sorting the items by decreasing value
+  std::sort(boxes.begin(), boxes.end(), [](MeshBox &elem1, MeshBox &elem2) {
+    return (elem1.height * elem1.width) > (elem2.width * elem2.height);
+  });
+  int id = 0;
+  for (auto &b : boxes)
+    b.id = id++;
+
+  std::cout << "Using bin format " << format << std::endl;
+
+  MeshBinVector bins;
+  std::vector<packing::MaxRects<LinkedPolygon>> spaces;
+  for (auto &box : boxes) {
+    // Best fit over all the open bins, the first one on ties
+    ulong best_bin = bins.size();
+    packing::MaxRects<LinkedPolygon>::Fit best;
+    for (ulong n_bin = 0; n_bin < bins.size(); n_bin++) {
+      auto fit = spaces[n_bin].findPosition(box);
+      if (fit.isBetter(best)) {
+        best_bin = n_bin;
+        best = fit;
+      }
+    }
+
+    // Else in a new bin, alone if even an empty bin is too small
+    if (best_bin == bins.size()) {
+      bins.push_back(MeshBin(format));
+      spaces.push_back(packing::MaxRects<LinkedPolygon>(format));
+      best = spaces[best_bin].findPosition(box);
+    }
+    if (best.isValid()) {
+      spaces[best_bin].place(box, best);
+    } else {
+      box.x = box.y = 0;
+      spaces[best_bin].fill();
+    }
+    bins[best_bin].boxes.push_back(box);
+    std::cout << "\tPut" << box << "in bin " << best_bin << std::endl;
+  }
+  return bins;
+}
+
 // ==========================================================================
 // Exporting
 // ==========================================================================
@@ -210,7 +311,7 @@ LinkedMeshPool::makeColorMap(const MeshBoxVector &boxes) const {
   for (auto &box : boxes) {
     // Get uids
     uids.resize(0);
-    box.root->getChildUIDs(uids);
+    box.root->getChildUIDs(*this, uids);
 
     auto color = gen.makeNewColor();
     std::cout << color.str() << std::endl;
@@ -224,37 +325,35 @@ LinkedMeshPool::makeColorMap(const MeshBoxVector &boxes) const {
 }
 
 std::string LinkedMeshPool::getAsSVGString(MeshBin &bin,
-                                           const args::Args &args) const {
+                                           const args::Args &args) {
   std::stringstream ss;
   ss << "<svg width=\"" << args.resolution * bin.format.width << "\"";
   ss << " height=\"" << args.resolution * bin.format.height << "\"";
   ss << " xmlns=\"http://www.w3.org/2000/svg\">\n";
   for (auto &box : bin.boxes) {
-    // Get translation + scaling transformation matrix
-    math::HMat mat;
+    // Get translation + scaling transformation
+    math::RigidTrsf mat;
     std::cout << "\t\tExporting " << box;
 
     // Rotation part
-    mat(0, 0) = args.resolution * ((box.rotated) ? 0 : 1);
-    mat(0, 1) = args.resolution * ((box.rotated) ? 1 : 0);
-    mat(1, 0) = args.resolution * ((box.rotated) ? -1 : 0);
-    mat(1, 1) = args.resolution * ((box.rotated) ? 0 : 1);
-    // mat(0, 0) = args.resolution;
-    // mat(1, 1) = args.resolution;
-    mat(2, 2) = args.resolution;
+    mat.R(0, 0) = (box.rotated) ? 0 : 1;
+    mat.R(0, 1) = (box.rotated) ? 1 : 0;
+    mat.R(1, 0) = (box.rotated) ? -1 : 0;
+    mat.R(1, 1) = (box.rotated) ? 0 : 1;
+    mat.s = args.resolution;
 
     // Translation part
-    mat(0, 3) = args.resolution * box.x;
-    mat(1, 3) =
+    mat.t(0) = args.resolution * box.x;
+    mat.t(1) =
         args.resolution * (box.y + ((box.rotated) ? box.getHeight() : 0));
 
-    auto b = box.root->getBounds(true, true);
+    auto b = box.root->getBounds(*this, true, true);
     std::cout << " of " << b << std::endl;
 
     std::cout << mat << std::endl;
 
-    box.root->fillSVGString(ss, mat, color_map.at(box.root->getUID()), 0,
-                            args.max_depth);
+    box.root->fillSVGString(*this, ss, mat, color_map.at(box.root->getUID()),
+                            0, args.max_depth);
 
     if (args.svg_debug) {
       ss << "<rect x=\"" << args.resolution * box.x << "\" y=\""
@@ -319,7 +418,7 @@ std::string LinkedMeshPool::getProjectionAsString(const math::Vec3 &ax1,
   std::vector<ProjectionOrder> order(_unfold_unlinked.size());
   for (ulong i = 0; i < _unfold_unlinked.size(); i++) {
     math::Barycenter bary;
-    _unfold_unlinked[i].getBarycenter(bary, false);
+    _unfold_unlinked[i].getBarycenter(_unfold_unlinked, bary, false);
     math::Vec3 bary3 = bary.getBarycenter();
     order[i] = ProjectionOrder{_unfold_unlinked[i].getUID(), bary3.dot(normal)};
   }
@@ -331,11 +430,9 @@ std::string LinkedMeshPool::getProjectionAsString(const math::Vec3 &ax1,
             });
 
   // Get transform matrix
-  math::HMat trsf;
+  math::RigidTrsf trsf;
   if (!_unfold_transformed) {
-    trsf(0, 0) = args.resolution;
-    trsf(1, 1) = args.resolution;
-    trsf(2, 2) = args.resolution;
+    trsf = math::RigidTrsf::scaling(args.resolution);
     _unfold_transformed = true;
   }
 
@@ -349,7 +446,7 @@ std::string LinkedMeshPool::getProjectionAsString(const math::Vec3 &ax1,
   ss << "\" xmlns=\"http://www.w3.org/2000/svg\">\n";
   for (const auto &order_elem : order) {
     _unfold_unlinked[order_elem.uid].fillSVGProjectString(
-        ss, trsf, ax1, ax2, color_map.at(order_elem.uid));
+        _unfold_unlinked, ss, trsf, ax1, ax2, color_map.at(order_elem.uid));
   }
   ss << "</svg>";
 
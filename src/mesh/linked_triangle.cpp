@@ -3,14 +3,21 @@
 
 namespace kami {
 
-LinkedTriangle::LinkedTriangle(microstl::Facet *_facet, ulong _id)
+LinkedTriangle::LinkedTriangle(PolygonArena<LinkedPolygon> &pool,
+                               const WeldedMesh &mesh, ulong _id)
     : LinkedPolygon() {
-  n = math::Vertex(_facet->n.x, _facet->n.y, _facet->n.z, 0);
+  n = mesh.normals[_id];
   n.normalize();
   uid = _id;
-  facets[0] = LinkedEdge<LinkedPolygon>{_facet->v1, _facet->v2};
-  facets[1] = LinkedEdge<LinkedPolygon>{_facet->v2, _facet->v3};
-  facets[2] = LinkedEdge<LinkedPolygon>{_facet->v3, _facet->v1};
+  first_edge = pool.edges.size();
+  n_edges = 3;
+  const math::VertexId *ids = mesh.getFacetCorners(_id);
+  for (int i = 0; i < 3; i++) {
+    pool.edges.emplace_back(mesh.vertices[ids[i]],
+                            mesh.vertices[ids[(i + 1) % 3]], ids[i],
+                            ids[(i + 1) % 3]);
+    pool.vertices.push_back(mesh.vertices[ids[i]]);
+  }
 }
 
 } // namespace kami
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "kami/mesh/overlap_graph.hpp"
+#include "kami/mesh/linked_poly.hpp"
+#include "kami/mesh/overlap_grid.hpp"
+#include <algorithm>
+
+namespace kami {
+
+// ==========================================================================
+// Construction
+// ==========================================================================
+
+OverlapGraph::OverlapGraph(const PolygonArena<LinkedPolygon> &pool,
+                           uint32_t root, TaskPool *tasks)
+    : bvh(pool, root), overlaps(pool.size()), was_read(pool.size(), false) {
+  // Nothing moved yet, the grid gives the candidates of all the facets
+  OverlapGrid grid(bvh, pool.size());
+
+  // Pairs found by the faces [first, last), with the ones of higher UID
+  typedef std::vector<std::pair<uint32_t, uint32_t>> Pairs;
+  auto detect = [&grid, &pool](uint32_t first, uint32_t last, Pairs &found) {
+    std::vector<uint32_t> candidates;
+    math::EdgeBlock edges, other_edges;
+    for (uint32_t f = first; f < last; f++) {
+      pool[f].getEdgeGeometries(pool, edges);
+      grid.getCandidates(f, candidates);
+      for (uint32_t other : candidates) {
+        pool[other].getEdgeGeometries(pool, other_edges);
+        if (other_edges.overlaps(edges))
+          found.push_back({f, other});
+      }
+    }
+  };
+
+  std::vector<Pairs> found((pool.size() + DETECT_GRAIN - 1) / DETECT_GRAIN);
+  auto detectRange = [&detect, &found, &pool](size_t range) {
+    uint32_t first = range * DETECT_GRAIN;
+    uint32_t last = std::min<size_t>(first + DETECT_GRAIN, pool.size());
+    detect(first, last, found[range]);
+  };
+  if (tasks == nullptr || found.size() < 2) {
+    for (size_t range = 0; range < found.size(); range++)
+      detectRange(range);
+  } else {
+    tasks->run([&] {
+      for (size_t range = 1; range < found.size(); range++)
+        tasks->submit([&detectRange, range] { detectRange(range); });
+      detectRange(0);
+    });
+  }
+
+  for (const Pairs &pairs : found) {
+    for (const auto &[face1, face2] : pairs)
+      link(face1, face2);
+  }
+}
+
+// ==========================================================================
+// Pairs
+// ==========================================================================
+
+void OverlapGraph::link(uint32_t face1, uint32_t face2) {
+  overlaps[face1].push_back(face2);
+  overlaps[face2].push_back(face1);
+}
+
+void OverlapGraph::unlinkAll(uint32_t face) {
+  for (uint32_t other : overlaps[face]) {
+    auto &row = overlaps[other];
+    auto it = std::find(row.begin(), row.end(), face);
+    if (it != row.end()) {
+      *it = row.back();
+      row.pop_back();
+    }
+  }
+  overlaps[face].resize(0);
+}
+
+void OverlapGraph::read(uint32_t face, overlaps::MeshOverlaps &out) {
+  for (uint32_t other : overlaps[face])
+    out.insert(overlaps::Overlap{face, other});
+  was_read[face] = true;
+}
+
+void OverlapGraph::update(const PolygonArena<LinkedPolygon> &pool,
+                          uint32_t part_root) {
+  // The moved facets were all read, only their pairs with unread facets
+  // matter. The subtree of a read facet is read, and the unread facets did not
+  // move since the hierarchy was built.
+  std::vector<uint32_t> part;
+  pool[part_root].getSubtree(pool, part, true);
+  for (uint32_t node : part)
+    unlinkAll(node);
+
+  std::vector<uint32_t> candidates;
+  math::EdgeBlock edges, other_edges;
+  for (uint32_t node : part) {
+    pool[node].getEdgeGeometries(pool, edges);
+    bvh.getCandidates(pool, TreeBVH::computeFaceBox(pool, node), node,
+                      candidates, &was_read);
+    for (uint32_t other : candidates) {
+      pool[other].getEdgeGeometries(pool, other_edges);
+      if (other_edges.overlaps(edges))
+        link(node, other);
+    }
+  }
+}
+
+} // namespace kami
@@ -0,0 +1,86 @@
+#include "kami/mesh/overlap_grid.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace kami {
+
+// ==========================================================================
+// Construction
+// ==========================================================================
+
+OverlapGrid::OverlapGrid(const TreeBVH &bvh, uint32_t n_faces)
+    : bvh(bvh), rects(n_faces) {
+  if (n_faces == 0)
+    return;
+
+  // Bounds of the boxes and their mean side
+  TreeBVH::Box bounds = bvh.getFaceBox(0);
+  double mean_side = 0;
+  for (uint32_t f = 0; f < n_faces; f++) {
+    const TreeBVH::Box &box = bvh.getFaceBox(f);
+    bounds += box;
+    mean_side += std::max(box.xmax - box.xmin, box.ymax - box.ymin);
+  }
+  mean_side /= n_faces;
+
+  // About one cell per facet, but no smaller than a facet so that a facet
+  // does not spread over many cells
+  double width = bounds.xmax - bounds.xmin, height = bounds.ymax - bounds.ymin;
+  double area = std::max(width * height, std::max(width, height) * mean_side);
+  cell_size = std::max(std::sqrt(area / n_faces), mean_side);
+  if (!(cell_size > 0))
+    cell_size = 1;
+  x0 = bounds.xmin;
+  y0 = bounds.ymin;
+  nx = (uint32_t)std::min<double>(std::floor(width / cell_size) + 1,
+                                  MAX_CELLS_PER_AXIS);
+  ny = (uint32_t)std::min<double>(std::floor(height / cell_size) + 1,
+                                  MAX_CELLS_PER_AXIS);
+  cells.resize(nx * ny);
+
+  for (uint32_t f = 0; f < n_faces; f++) {
+    const CellRect &rect = rects[f] = getCells(bvh.getFaceBox(f));
+    for (uint32_t y = rect.y0; y <= rect.y1; y++) {
+      for (uint32_t x = rect.x0; x <= rect.x1; x++)
+        cells[y * nx + x].push_back(f);
+    }
+  }
+}
+
+OverlapGrid::CellRect OverlapGrid::getCells(const TreeBVH::Box &box) const {
+  auto cell = [this](double v, double origin, uint32_t n) {
+    double c = std::floor((v - origin) / cell_size);
+    return (uint32_t)std::clamp(c, 0.0, (double)(n - 1));
+  };
+  return CellRect{cell(box.xmin, x0, nx), cell(box.ymin, y0, ny),
+                  cell(box.xmax, x0, nx), cell(box.ymax, y0, ny)};
+}
+
+// ==========================================================================
+// Queries
+// ==========================================================================
+
+void OverlapGrid::getCandidates(uint32_t face,
+                                std::vector<uint32_t> &candidates) const {
+  candidates.resize(0);
+  if (cells.empty())
+    return;
+  const CellRect &rect = rects[face];
+  const TreeBVH::Box &box = bvh.getFaceBox(face);
+  for (uint32_t y = rect.y0; y <= rect.y1; y++) {
+    for (uint32_t x = rect.x0; x <= rect.x1; x++) {
+      for (uint32_t other : cells[y * nx + x]) {
+        // Only in the first cell both boxes touch
+        const CellRect &other_rect = rects[other];
+        if (other <= face || x != std::max(rect.x0, other_rect.x0) ||
+            y != std::max(rect.y0, other_rect.y0))
+          continue;
+        if (bvh.getFaceBox(other).meets(box))
+          candidates.push_back(other);
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+}
+
+} // namespace kami
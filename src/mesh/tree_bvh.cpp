@@ -0,0 +1,88 @@
+#include "kami/mesh/tree_bvh.hpp"
+#include "kami/mesh/linked_poly.hpp"
+#include <algorithm>
+
+namespace kami {
+
+// ==========================================================================
+// Construction
+// ==========================================================================
+
+TreeBVH::TreeBVH(const PolygonArena<LinkedPolygon> &pool, uint32_t root)
+    : face_boxes(pool.size()), subtree_boxes(pool.size()) {
+  std::vector<uint32_t> tree;
+  pool[root].getSubtree(pool, tree, false);
+  std::vector<bool> in_tree(pool.size(), false);
+  for (uint32_t node : tree)
+    in_tree[node] = true;
+
+  for (uint32_t f = 0; f < pool.size(); f++)
+    face_boxes[f] = computeFaceBox(pool, f);
+
+  // Children first, the facets out of the tree being their own root
+  roots.push_back(root);
+  for (size_t k = tree.size(); k-- > 0;)
+    mergeChildren(pool, tree[k]);
+  for (uint32_t f = 0; f < pool.size(); f++) {
+    if (!in_tree[f]) {
+      roots.push_back(f);
+      subtree_boxes[f] = face_boxes[f];
+    }
+  }
+}
+
+// ==========================================================================
+// Boxes
+// ==========================================================================
+
+TreeBVH::Box TreeBVH::computeFaceBox(const PolygonArena<LinkedPolygon> &pool,
+                                     uint32_t face) {
+  const LinkedPolygon &poly = pool[face];
+  math::Vertex v = poly.getVertex(pool, 0);
+  Box box{v(0), v(0), v(1), v(1)};
+  for (int i = 1; i < poly.getEdges(pool).size(); i++) {
+    v = poly.getVertex(pool, i);
+    box += Box{v(0), v(0), v(1), v(1)};
+  }
+  return box;
+}
+
+void TreeBVH::mergeChildren(const PolygonArena<LinkedPolygon> &pool,
+                            uint32_t face) {
+  subtree_boxes[face] = face_boxes[face];
+  for (const auto &edge : pool[face].getEdges(pool)) {
+    if (edge.isOwned())
+      subtree_boxes[face] += subtree_boxes[edge.getMesh()];
+  }
+}
+
+// ==========================================================================
+// Queries
+// ==========================================================================
+
+void TreeBVH::getCandidates(const PolygonArena<LinkedPolygon> &pool,
+                            const Box &box, uint32_t face,
+                            std::vector<uint32_t> &candidates,
+                            const std::vector<bool> *skipped) const {
+  candidates.resize(0);
+  std::vector<uint32_t> stack;
+  for (uint32_t root : roots) {
+    stack.push_back(root);
+    while (!stack.empty()) {
+      uint32_t node = stack.back();
+      stack.pop_back();
+      if (!subtree_boxes[node].meets(box) ||
+          (skipped != nullptr && (*skipped)[node]))
+        continue;
+      if (node != face && face_boxes[node].meets(box))
+        candidates.push_back(node);
+      for (const auto &edge : pool[node].getEdges(pool)) {
+        if (edge.isOwned())
+          stack.push_back(edge.getMesh());
+      }
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+}
+
+} // namespace kami
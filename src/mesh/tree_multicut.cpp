@@ -0,0 +1,533 @@
+#include "kami/mesh/tree_multicut.hpp"
+#include "kami/mesh/disjoint_set.hpp"
+#include "kami/mesh/linked_poly.hpp"
+#include <algorithm>
+#include <numeric>
+#include <queue>
+
+namespace kami {
+
+// ==========================================================================
+// Exact cover of a small group
+// ==========================================================================
+
+/**
+ * @brief Branch and bound over the edges hitting a group of at most 64 pairs,
+ * each edge given by the mask of the pairs it separates. The branches stop
+ * once the budget is spent, the best cover found being kept in best, of size
+ * best_count.
+ */
+static void searchCover(const std::vector<uint64_t> &masks, uint64_t uncovered,
+                        std::vector<size_t> &chosen, std::vector<size_t> &best,
+                        size_t &best_count, size_t &budget) {
+  if (uncovered == 0) {
+    best = chosen;
+    best_count = chosen.size();
+    return;
+  }
+  if (budget == 0 || chosen.size() + 1 >= best_count)
+    return;
+  budget--;
+
+  // The first uncovered pair needs one of its edges, the widest first
+  uint64_t pair = uncovered & (~uncovered + 1);
+  std::vector<size_t> branches;
+  for (size_t i = 0; i < masks.size(); i++) {
+    if (masks[i] & pair)
+      branches.push_back(i);
+  }
+  std::stable_sort(branches.begin(), branches.end(), [&](size_t a, size_t b) {
+    return __builtin_popcountll(masks[a] & uncovered) >
+           __builtin_popcountll(masks[b] & uncovered);
+  });
+  for (size_t i : branches) {
+    chosen.push_back(i);
+    searchCover(masks, uncovered & ~masks[i], chosen, best, best_count, budget);
+    chosen.pop_back();
+  }
+}
+
+// ==========================================================================
+// Construction
+// ==========================================================================
+
+TreeMulticut::TreeMulticut(const PolygonArena<LinkedPolygon> &pool,
+                           uint32_t root, const overlaps::MeshOverlaps &pairs)
+    : parent(pool.size(), NO_NODE), depth(pool.size(), NO_NODE),
+      uses(pool.size(), 0), cut(pool.size(), false),
+      edge_masks(pool.size(), 0) {
+  std::vector<uint32_t> tree;
+  pool[root].getSubtree(pool, tree, false);
+  depth[root] = 0;
+  for (uint32_t node : tree) {
+    for (const auto &edge : pool[node].getEdges(pool)) {
+      if (edge.isOwned()) {
+        parent[edge.getMesh()] = node;
+        depth[edge.getMesh()] = depth[node] + 1;
+      }
+    }
+  }
+
+  for (const auto &pair : pairs)
+    addDemand(pair.id1, pair.id2);
+
+  // Deepest common ancestors first, the pairs of an ancestor together
+  std::vector<size_t> order(demands.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+    uint32_t anc_a = demands[a].ancestor, anc_b = demands[b].ancestor;
+    if (depth[anc_a] != depth[anc_b])
+      return depth[anc_a] > depth[anc_b];
+    return anc_a < anc_b;
+  });
+  std::vector<size_t> group;
+  for (size_t k = 0; k < order.size(); k++) {
+    group.push_back(order[k]);
+    if (k + 1 == order.size() ||
+        demands[order[k + 1]].ancestor != demands[order[k]].ancestor) {
+      coverChildren(group);
+      group.clear();
+    }
+  }
+
+  improveGroups();
+  improveWindows();
+  n_cuts = std::count(cut.begin(), cut.end(), true);
+}
+
+void TreeMulticut::addDemand(uint32_t face1, uint32_t face2) {
+  if (depth[face1] == NO_NODE || depth[face2] == NO_NODE)
+    return;
+
+  // Climb from the deepest facet, then from both up to the common ancestor
+  Demand demand;
+  demand.start = path.size();
+  std::vector<uint32_t> second;
+  while (depth[face1] > depth[face2]) {
+    path.push_back(face1);
+    face1 = parent[face1];
+  }
+  while (depth[face2] > depth[face1]) {
+    second.push_back(face2);
+    face2 = parent[face2];
+  }
+  while (face1 != face2) {
+    path.push_back(face1);
+    face1 = parent[face1];
+    second.push_back(face2);
+    face2 = parent[face2];
+  }
+  demand.ancestor = face1;
+  demand.middle = path.size();
+  path.insert(path.end(), second.begin(), second.end());
+  demand.end = path.size();
+
+  for (size_t k = demand.start; k < demand.end; k++)
+    uses[path[k]]++;
+  demands.push_back(demand);
+}
+
+bool TreeMulticut::isSeparated(const Demand &demand) const {
+  for (size_t k = demand.start; k < demand.end; k++) {
+    if (cut[path[k]])
+      return true;
+  }
+  return false;
+}
+
+// ==========================================================================
+// Greedy cover
+// ==========================================================================
+
+void TreeMulticut::coverChildren(const std::vector<size_t> &group) {
+  // A pair whose facet is the ancestor can only cut the side of the other one
+  std::vector<std::pair<uint32_t, uint32_t>> conflicts;
+  for (size_t d : group) {
+    const Demand &demand = demands[d];
+    if (isSeparated(demand))
+      continue;
+    uint32_t side1 = demand.getSide(path, false);
+    uint32_t side2 = demand.getSide(path, true);
+    if (side1 == NO_NODE || side2 == NO_NODE)
+      cut[(side1 == NO_NODE) ? side2 : side1] = true;
+    else
+      conflicts.push_back({side1, side2});
+  }
+  conflicts.erase(std::remove_if(conflicts.begin(), conflicts.end(),
+                                 [this](const auto &conflict) {
+                                   return cut[conflict.first] ||
+                                          cut[conflict.second];
+                                 }),
+                  conflicts.end());
+  if (conflicts.empty())
+    return;
+
+  std::vector<uint32_t> sides;
+  for (const auto &[side1, side2] : conflicts) {
+    sides.push_back(side1);
+    sides.push_back(side2);
+  }
+  std::sort(sides.begin(), sides.end());
+  sides.erase(std::unique(sides.begin(), sides.end()), sides.end());
+  auto index = [&sides](uint32_t side) {
+    return std::lower_bound(sides.begin(), sides.end(), side) - sides.begin();
+  };
+
+  // Smallest cover, then the one holding the most paths towards the root
+  if (sides.size() <= EXACT_CHILDREN) {
+    std::vector<uint32_t> conflict_masks;
+    for (const auto &[side1, side2] : conflicts)
+      conflict_masks.push_back((1u << index(side1)) | (1u << index(side2)));
+
+    uint32_t best = 0;
+    int best_count = sides.size() + 1;
+    uint64_t best_uses = 0;
+    for (uint32_t mask = 1; mask < (1u << sides.size()); mask++) {
+      int count = __builtin_popcount(mask);
+      if (count > best_count)
+        continue;
+      bool covers = true;
+      for (size_t c = 0; c < conflict_masks.size() && covers; c++)
+        covers = (conflict_masks[c] & mask) != 0;
+      if (!covers)
+        continue;
+      uint64_t mask_uses = 0;
+      for (size_t i = 0; i < sides.size(); i++) {
+        if (mask & (1u << i))
+          mask_uses += uses[sides[i]];
+      }
+      if (count < best_count || mask_uses > best_uses) {
+        best = mask;
+        best_count = count;
+        best_uses = mask_uses;
+      }
+    }
+    for (size_t i = 0; i < sides.size(); i++) {
+      if (best & (1u << i))
+        cut[sides[i]] = true;
+    }
+    return;
+  }
+
+  // Too many children, the one in the most conflicts first
+  while (!conflicts.empty()) {
+    std::vector<uint32_t> degree(sides.size(), 0);
+    for (const auto &[side1, side2] : conflicts) {
+      degree[index(side1)]++;
+      degree[index(side2)]++;
+    }
+    size_t best = 0;
+    for (size_t i = 1; i < sides.size(); i++) {
+      if (degree[i] > degree[best] ||
+          (degree[i] == degree[best] && uses[sides[i]] > uses[sides[best]]))
+        best = i;
+    }
+    cut[sides[best]] = true;
+    conflicts.erase(std::remove_if(conflicts.begin(), conflicts.end(),
+                                   [this](const auto &conflict) {
+                                     return cut[conflict.first] ||
+                                            cut[conflict.second];
+                                   }),
+                    conflicts.end());
+  }
+}
+
+// ==========================================================================
+// Exact groups
+// ==========================================================================
+
+void TreeMulticut::improveGroups() {
+  // Union of the pairs sharing an edge
+  DisjointSet sets(demands.size());
+  std::vector<uint32_t> owner(parent.size(), NO_NODE);
+  for (size_t d = 0; d < demands.size(); d++) {
+    for (size_t k = demands[d].start; k < demands[d].end; k++) {
+      if (owner[path[k]] == NO_NODE)
+        owner[path[k]] = d;
+      else
+        sets.unite(d, owner[path[k]]);
+    }
+  }
+  std::vector<std::vector<size_t>> groups(demands.size());
+  for (size_t d = 0; d < demands.size(); d++)
+    groups[sets.find(d)].push_back(d);
+
+  std::vector<bool> widest = coverWidest();
+  removeRedundant(cut);
+  removeRedundant(widest);
+
+  std::vector<bool> in_group(parent.size(), false);
+  for (const auto &group : groups) {
+    if (group.empty())
+      continue;
+    n_groups++;
+
+    // Edges of the group, the groups having no edge in common
+    std::vector<uint32_t> edges;
+    for (size_t d : group) {
+      for (size_t k = demands[d].start; k < demands[d].end; k++) {
+        if (!in_group[path[k]]) {
+          in_group[path[k]] = true;
+          edges.push_back(path[k]);
+        }
+      }
+    }
+    size_t greedy_count = 0, widest_count = 0;
+    for (uint32_t edge : edges) {
+      greedy_count += cut[edge];
+      widest_count += widest[edge];
+      in_group[edge] = false;
+    }
+    if (widest_count < greedy_count) {
+      for (uint32_t edge : edges)
+        cut[edge] = widest[edge];
+      greedy_count = widest_count;
+    }
+    std::vector<size_t> minimal = getMinimalPairs(group, EXACT_PAIRS);
+    if (minimal.size() > EXACT_PAIRS)
+      continue;
+
+    std::vector<uint32_t> cover;
+    n_exact += coverExactly(minimal, greedy_count, EXACT_BUDGET, cover);
+    if (!cover.empty()) {
+      for (uint32_t edge : edges)
+        cut[edge] = false;
+      for (uint32_t edge : cover)
+        cut[edge] = true;
+    }
+  }
+}
+
+std::vector<size_t>
+TreeMulticut::getMinimalPairs(const std::vector<size_t> &group,
+                              size_t limit) {
+  // Shortest paths first, a path holding a kept one being left out
+  std::vector<size_t> sorted(group);
+  std::stable_sort(sorted.begin(), sorted.end(), [this](size_t a, size_t b) {
+    return demands[a].end - demands[a].start <
+           demands[b].end - demands[b].start;
+  });
+  std::vector<size_t> minimal;
+  for (size_t d : sorted) {
+    if (minimal.size() > limit)
+      break;
+    for (size_t k = demands[d].start; k < demands[d].end; k++)
+      edge_masks[path[k]] = 1;
+    bool held = false;
+    for (size_t i = 0; i < minimal.size() && !held; i++) {
+      const Demand &kept = demands[minimal[i]];
+      held = true;
+      for (size_t k = kept.start; k < kept.end && held; k++)
+        held = edge_masks[path[k]] != 0;
+    }
+    for (size_t k = demands[d].start; k < demands[d].end; k++)
+      edge_masks[path[k]] = 0;
+    if (!held)
+      minimal.push_back(d);
+  }
+  return minimal;
+}
+
+bool TreeMulticut::coverExactly(const std::vector<size_t> &group,
+                                size_t bound, size_t budget,
+                                std::vector<uint32_t> &cover) {
+  // The pairs each edge separates
+  std::vector<uint32_t> edges;
+  for (size_t i = 0; i < group.size(); i++) {
+    const Demand &demand = demands[group[i]];
+    for (size_t k = demand.start; k < demand.end; k++) {
+      if (edge_masks[path[k]] == 0)
+        edges.push_back(path[k]);
+      edge_masks[path[k]] |= (uint64_t)1 << i;
+    }
+  }
+
+  // Shallowest edge of each set of pairs, without the sets held by another
+  std::sort(edges.begin(), edges.end(), [&](uint32_t a, uint32_t b) {
+    if (edge_masks[a] != edge_masks[b])
+      return edge_masks[a] < edge_masks[b];
+    return (depth[a] != depth[b]) ? depth[a] < depth[b] : a < b;
+  });
+  std::vector<uint32_t> candidates;
+  std::vector<uint64_t> masks;
+  for (size_t i = 0; i < edges.size(); i++) {
+    if (i > 0 && edge_masks[edges[i]] == edge_masks[edges[i - 1]])
+      continue;
+    candidates.push_back(edges[i]);
+    masks.push_back(edge_masks[edges[i]]);
+  }
+  std::vector<bool> dominated(masks.size(), false);
+  for (size_t i = 0; i < masks.size(); i++) {
+    for (size_t j = 0; j < masks.size() && !dominated[i]; j++)
+      dominated[i] = (j != i) && (masks[i] & masks[j]) == masks[i];
+  }
+  for (size_t i = masks.size(); i-- > 0;) {
+    if (dominated[i]) {
+      candidates.erase(candidates.begin() + i);
+      masks.erase(masks.begin() + i);
+    }
+  }
+  for (uint32_t edge : edges)
+    edge_masks[edge] = 0;
+
+  std::vector<size_t> chosen, best;
+  size_t best_count = bound;
+  uint64_t all = (group.size() == 64) ? ~(uint64_t)0
+                                      : ((uint64_t)1 << group.size()) - 1;
+  searchCover(masks, all, chosen, best, best_count, budget);
+  cover.clear();
+  if (best_count < bound) {
+    for (size_t i : best)
+      cover.push_back(candidates[i]);
+  }
+  return budget > 0;
+}
+
+// ==========================================================================
+// Exact windows
+// ==========================================================================
+
+void TreeMulticut::improveWindows() {
+  // Pairs through each edge, and cuts on the path of each pair
+  std::vector<std::vector<size_t>> through(parent.size());
+  std::vector<uint32_t> covers(demands.size(), 0);
+  for (size_t d = 0; d < demands.size(); d++) {
+    for (size_t k = demands[d].start; k < demands[d].end; k++) {
+      through[path[k]].push_back(d);
+      covers[d] += cut[path[k]];
+    }
+  }
+
+  std::vector<uint32_t> hits(demands.size(), 0);
+  std::vector<bool> in_window(parent.size(), false);
+  size_t saved;
+  do {
+    saved = n_saved;
+    for (uint32_t node = 0; node < parent.size(); node++) {
+      if (!cut[node])
+        continue;
+
+      // The cut and the other cuts on the paths it separates
+      std::vector<uint32_t> window{node};
+      in_window[node] = true;
+      for (size_t i = 0;
+           i < through[node].size() && window.size() < WINDOW_CUTS; i++) {
+        const Demand &demand = demands[through[node][i]];
+        for (size_t k = demand.start;
+             k < demand.end && window.size() < WINDOW_CUTS; k++) {
+          if (cut[path[k]] && !in_window[path[k]]) {
+            in_window[path[k]] = true;
+            window.push_back(path[k]);
+          }
+        }
+      }
+
+      // The pairs separated by the cuts of the window alone
+      std::vector<size_t> group;
+      for (uint32_t edge : window) {
+        for (size_t d : through[edge]) {
+          if (++hits[d] == covers[d])
+            group.push_back(d);
+        }
+      }
+      for (uint32_t edge : window) {
+        in_window[edge] = false;
+        for (size_t d : through[edge])
+          hits[d] = 0;
+      }
+      if (window.size() < 2)
+        continue;
+      group = getMinimalPairs(group, EXACT_PAIRS);
+      if (group.size() > EXACT_PAIRS)
+        continue;
+
+      std::vector<uint32_t> cover;
+      n_windows += coverExactly(group, window.size(), WINDOW_BUDGET, cover);
+      if (cover.empty())
+        continue;
+      n_saved += window.size() - cover.size();
+      for (uint32_t edge : window) {
+        cut[edge] = false;
+        for (size_t d : through[edge])
+          covers[d]--;
+      }
+      for (uint32_t edge : cover) {
+        cut[edge] = true;
+        for (size_t d : through[edge])
+          covers[d]++;
+      }
+    }
+  } while (n_saved > saved);
+  removeRedundant(cut);
+}
+
+std::vector<bool> TreeMulticut::coverWidest() const {
+  std::vector<std::vector<size_t>> through(parent.size());
+  for (size_t d = 0; d < demands.size(); d++) {
+    for (size_t k = demands[d].start; k < demands[d].end; k++)
+      through[path[k]].push_back(d);
+  }
+
+  // The counts only decrease: an outdated edge is pushed again with its count
+  std::vector<uint32_t> count(uses);
+  std::vector<bool> separated(demands.size(), false), cuts(parent.size(), false);
+  std::priority_queue<std::pair<uint32_t, uint32_t>> queue;
+  for (uint32_t node = 0; node < parent.size(); node++) {
+    if (count[node] > 0)
+      queue.push({count[node], node});
+  }
+  while (!queue.empty()) {
+    auto [n_paths, node] = queue.top();
+    queue.pop();
+    if (n_paths != count[node]) {
+      if (count[node] > 0)
+        queue.push({count[node], node});
+      continue;
+    }
+
+    cuts[node] = true;
+    for (size_t d : through[node]) {
+      if (separated[d])
+        continue;
+      separated[d] = true;
+      for (size_t k = demands[d].start; k < demands[d].end; k++)
+        count[path[k]]--;
+    }
+  }
+  return cuts;
+}
+
+void TreeMulticut::removeRedundant(std::vector<bool> &cuts) const {
+  // Cuts on the path of each pair, and pairs through each cut
+  std::vector<uint32_t> covers(demands.size(), 0);
+  std::vector<std::vector<size_t>> through(parent.size());
+  for (size_t d = 0; d < demands.size(); d++) {
+    for (size_t k = demands[d].start; k < demands[d].end; k++) {
+      if (cuts[path[k]]) {
+        covers[d]++;
+        through[path[k]].push_back(d);
+      }
+    }
+  }
+
+  std::vector<uint32_t> order;
+  for (uint32_t node = 0; node < parent.size(); node++) {
+    if (cuts[node])
+      order.push_back(node);
+  }
+  std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+    return uses[a] < uses[b];
+  });
+  for (uint32_t node : order) {
+    bool redundant = true;
+    for (size_t k = 0; k < through[node].size() && redundant; k++)
+      redundant = covers[through[node][k]] > 1;
+    if (!redundant)
+      continue;
+    cuts[node] = false;
+    for (size_t d : through[node])
+      covers[d]--;
+  }
+}
+
+} // namespace kami
@@ -0,0 +1,141 @@
+#include "kami/mesh/welding.hpp"
+#include <cmath>
+
+namespace kami {
+
+// ==========================================================================
+// Hash grid
+// ==========================================================================
+
+struct CellKey {
+  int32_t x, y, z;
+
+  inline bool operator==(const CellKey &other) const {
+    return x == other.x && y == other.y && z == other.z;
+  }
+};
+
+inline uint64_t hashCell(const CellKey &k) {
+  uint64_t h = (uint32_t)k.x * 0x9E3779B97F4A7C15ull;
+  h = (h ^ (h >> 29) ^ (uint32_t)k.y) * 0xBF58476D1CE4E5B9ull;
+  h = (h ^ (h >> 32) ^ (uint32_t)k.z) * 0x94D049BB133111EBull;
+  return h ^ (h >> 31);
+}
+
+/**
+ * @brief Open-addressing map from a grid cell to the last vertex inserted in
+ * it. The table grows to stay at most half full.
+ */
+struct CellTable {
+  struct Slot {
+    CellKey key;
+    math::VertexId last = math::NO_VERTEX;
+  };
+
+  CellTable(size_t expected_cells) { allocate(2 * expected_cells); }
+
+  void allocate(size_t min_capacity) {
+    size_t capacity = 16;
+    while (capacity < min_capacity)
+      capacity <<= 1;
+    slots.assign(capacity, Slot());
+    mask = capacity - 1;
+  }
+
+  /**
+   * @brief Return the slot of the given cell, or the empty slot where it
+   * should be inserted.
+   */
+  inline Slot &find(const CellKey &key) {
+    size_t i = hashCell(key) & mask;
+    while (slots[i].last != math::NO_VERTEX && !(slots[i].key == key))
+      i = (i + 1) & mask;
+    return slots[i];
+  }
+
+  /**
+   * @brief Set the last vertex of the given cell
+   */
+  inline void set(Slot &slot, const CellKey &key, math::VertexId id) {
+    if (slot.last == math::NO_VERTEX)
+      count++;
+    slot.key = key;
+    slot.last = id;
+
+    if (2 * count > slots.size()) {
+      auto old_slots = std::move(slots);
+      allocate(2 * old_slots.size());
+      for (const Slot &old : old_slots) {
+        if (old.last != math::NO_VERTEX)
+          find(old.key) = old;
+      }
+    }
+  }
+
+  std::vector<Slot> slots;
+  size_t mask;
+  size_t count = 0;
+};
+
+// ==========================================================================
+// Welding
+// ==========================================================================
+
+WeldedMesh weldVertices(const io::StlMesh &mesh, double tolerance) {
+  WeldedMesh out;
+  out.corners.resize(3 * mesh.size());
+  out.normals.reserve(mesh.size());
+  out.vertices.reserve(mesh.size() / 2 + 3);
+
+  const double cell_size = 2 * tolerance;
+  const double tolerance2 = tolerance * tolerance;
+
+  // Last vertex of each cell, the others are chained through next
+  CellTable cells(mesh.size() / 2);
+  std::vector<math::VertexId> next;
+  next.reserve(out.vertices.capacity());
+
+  auto weld = [&](const float position[3]) {
+    math::Vertex v(position);
+
+    // A vertex closer than the tolerance is either in this cell, or in the
+    // neighbour on the closest side for each axis
+    int32_t base[3], side[3];
+    for (int a = 0; a < 3; a++) {
+      double q = v(a) / cell_size;
+      base[a] = (int32_t)std::floor(q);
+      side[a] = (q - base[a] < 0.5) ? -1 : 1;
+    }
+    for (int n = 0; n < 8; n++) {
+      auto &slot = cells.find(CellKey{base[0] + ((n & 1) ? side[0] : 0),
+                                      base[1] + ((n & 2) ? side[1] : 0),
+                                      base[2] + ((n & 4) ? side[2] : 0)});
+      for (math::VertexId id = slot.last; id != math::NO_VERTEX;
+           id = next[id]) {
+        if (math::Vertex::distance2(out.vertices[id], v) < tolerance2)
+          return id;
+      }
+    }
+
+    // New vertex
+    math::VertexId id = out.vertices.size();
+    out.vertices.push_back(v);
+    CellKey key{base[0], base[1], base[2]};
+    auto &slot = cells.find(key);
+    next.push_back(slot.last);
+    cells.set(slot, key, id);
+    return id;
+  };
+
+  for (size_t i = 0; i < mesh.size(); i++) {
+    io::StlFacet facet = mesh[i];
+    out.corners[3 * i + 0] = weld(facet.v1);
+    out.corners[3 * i + 1] = weld(facet.v2);
+    out.corners[3 * i + 2] = weld(facet.v3);
+    out.normals.push_back(math::Vertex(facet.n[0], facet.n[1], facet.n[2], 0));
+  }
+
+  return out;
+}
+
+} // namespace kami
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+"""Write a bumpy UV sphere as a binary STL, for the benchmarks.
+
+Usage : make_sphere.py <rings> <output file>
+
+A sphere of n rings has 2n segments and 4n(n - 1) facets: 30 rings give 3480
+facets, 60 rings give 14160 facets.
+"""
+import math
+import struct
+import sys
+
+
+def point(n, i, j):
+    theta = math.pi * i / n
+    phi = 2 * math.pi * j / (2 * n)
+    r = 10 * (1 + 0.15 * math.sin(3 * theta) * math.cos(5 * phi))
+    return (r * math.sin(theta) * math.cos(phi),
+            r * math.sin(theta) * math.sin(phi),
+            r * math.cos(theta))
+
+
+def normal(tri):
+    a, b, c = tri
+    u = [b[k] - a[k] for k in range(3)]
+    v = [c[k] - a[k] for k in range(3)]
+    x = [u[1] * v[2] - u[2] * v[1],
+         u[2] * v[0] - u[0] * v[2],
+         u[0] * v[1] - u[1] * v[0]]
+    length = math.sqrt(sum(e * e for e in x)) or 1
+    return [e / length for e in x]
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        sys.exit(1)
+    n = int(sys.argv[1])
+    tris = []
+    for i in range(n):
+        for j in range(2 * n):
+            a, b = point(n, i, j), point(n, i + 1, j)
+            c, d = point(n, i + 1, j + 1), point(n, i, j + 1)
+            if i > 0:
+                tris.append((a, b, d))
+            if i < n - 1:
+                tris.append((b, c, d))
+
+    with open(sys.argv[2], 'wb') as f:
+        f.write(b'\0' * 80)
+        f.write(struct.pack('<I', len(tris)))
+        for tri in tris:
+            f.write(struct.pack('<3f', *normal(tri)))
+            for v in tri:
+                f.write(struct.pack('<3f', *v))
+            f.write(b'\0\0')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Compare the packing engines (-p tprf and -p maxrects) on the sample meshes
+# and on generated spheres: parts, sheets and packing time of each run.
+#
+# Usage : ./packing_bench.sh [kami binary]   (default ../build/kami)
+
+KAMI=${1:-../build/kami}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+python3 make_sphere.py 30 "$OUT/s30.stl"
+python3 make_sphere.py 60 "$OUT/s60.stl"
+
+run() {
+  # run <mesh> <scale> <slicing>
+  for engine in tprf maxrects; do
+    dir="$OUT/$engine"
+    rm -rf "$dir"
+    mkdir -p "$dir"
+    "$KAMI" -i "$1" -o "$dir/x" -s "$2" -c "$3" -p "$engine" >"$dir/log" 2>&1
+    parts=$(grep -o 'Got [0-9]* parts' "$dir/log" | cut -d' ' -f2)
+    sheets=$(ls "$dir" | grep -c 'x_[0-9]*\.svg')
+    time=$(awk '/Paper box packing/{f=1} f&&/Took/{print $3; exit}' "$dir/log")
+    printf "%-24s %5s %-7s %-9s %6s %7s %9s\n" "$(basename "$1")" "$2" "$3" \
+      "$engine" "$parts" "$sheets" "$time"
+  done
+}
+
+printf "%-24s %5s %-7s %-9s %6s %7s %9s\n" mesh scale slicing engine parts \
+  sheets "pack(ms)"
+run low_poly_cat.stl 4 greedy
+run low_poly_yellow_cat.stl 4 greedy
+run "$OUT/s30.stl" 4 greedy
+run "$OUT/s30.stl" 8 greedy
+run "$OUT/s60.stl" 1 greedy
+run "$OUT/s60.stl" 3 greedy
+run "$OUT/s60.stl" 3 mincut